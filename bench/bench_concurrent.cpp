@@ -0,0 +1,63 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TMultiStack.h"
+#include "TConcurrentStack.h"
+#include "TFlatCombiningStack.h"
+
+using namespace std;
+
+// Каждый поток выполняет ops пар Push/Pop; результат - миллионы операций в секунду
+template <class F>
+double Run(int threads, int ops, F op) {
+    vector<thread> pool;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back([&, t]() { for (int i = 0; i < ops; i++) op(t * ops + i); });
+    for (auto& th : pool) th.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return 2.0 * threads * ops / sec / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = argc > 1 ? atoi(argv[1]) : 64;
+    int ops = argc > 2 ? atoi(argv[2]) : 200000;
+    int eliminationSize = argc > 3 ? atoi(argv[3]) : 16;
+    int backoffSpins = argc > 4 ? atoi(argv[4]) : 256;
+
+    cout << "threads\tmutex+TStack\tTConcurrentStack\t+elimination\tflat combining  (Mops/s)\n";
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        TStack<int> st(1024);
+        st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+        mutex m;
+        double locked = Run(threads, ops, [&](int v) {
+            { lock_guard<mutex> g(m); st.Push(v); }
+            { lock_guard<mutex> g(m); st.Pop(); }
+        });
+
+        TConcurrentStack<int> cs;
+        double lockFree = Run(threads, ops, [&](int v) {
+            int out;
+            cs.Push(v);
+            cs.TryPop(out);
+        });
+        TConcurrentStack<int> es(eliminationSize, backoffSpins);
+        double eliminated = Run(threads, ops, [&](int v) {
+            int out;
+            es.Push(v);
+            es.TryPop(out);
+        });
+        TFlatCombiningStack<int> fc;
+        double combined = Run(threads, ops, [&](int v) {
+            int out;
+            fc.Push(v);
+            fc.TryPop(out);
+        });
+        cout << threads << "\t" << locked << "\t\t" << lockFree << "\t\t\t" << eliminated << "\t\t" << combined << "\n";
+    }
+    return 0;
+}
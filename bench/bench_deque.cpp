@@ -0,0 +1,50 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "TWorkStealingDeque.h"
+
+using namespace std;
+
+// Владелец кладет ops элементов и снимает каждый второй, воры непрерывно пытаются красть.
+// Выводится скорость владельца и доля успешных попыток кражи
+int main(int argc, char** argv)
+{
+    int maxThieves = argc > 1 ? atoi(argv[1]) : 8;
+    int ops = argc > 2 ? atoi(argv[2]) : 2000000;
+
+    cout << "thieves\towner Mops/s\tsteals\tsteal attempts\tsuccess rate\n";
+    for (int thieves = 0; thieves <= maxThieves; thieves = thieves ? thieves * 2 : 1) {
+        TWorkStealingDeque<int> dq(1024);
+        atomic<bool> done(false);
+        atomic<long long> stolen(0), attempts(0);
+        vector<thread> pool;
+        for (int k = 0; k < thieves; k++) {
+            pool.emplace_back([&]() {
+                long long s = 0, a = 0;
+                int v;
+                while (!done.load(memory_order_relaxed)) {
+                    a++;
+                    if (dq.Steal(v)) s++;
+                }
+                stolen += s;
+                attempts += a;
+            });
+        }
+        auto start = chrono::steady_clock::now();
+        int v;
+        for (int i = 0; i < ops; i++) {
+            dq.Push(i);
+            if (i & 1) dq.TryPop(v);
+        }
+        while (dq.TryPop(v));
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        done.store(true);
+        for (auto& th : pool) th.join();
+        cout << thieves << "\t" << ops * 1.5 / sec / 1e6 << "\t\t" << stolen << "\t" << attempts << "\t\t"
+             << (attempts ? 100.0 * stolen / attempts : 0.0) << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include "TMultiStack.h"
+
+using namespace std;
+
+template <class T>
+static void Run(const char* name, int len, int reps)
+{
+    TStack<T> st(len);
+    unsigned seed = 12345;
+    for (int i = 0; i < len; i++) {
+        seed = seed * 1664525 + 1013904223;
+        st.Push((T)(int)(seed >> 4));
+    }
+
+    T scalar = T();
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        const T* data = &st.Top() - (len - 1);
+        T m = data[0];
+        for (int i = 1; i < len; i++)
+            if (data[i] < m) m = data[i];
+        scalar = m;
+    }
+    double scalarTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    T simd = T();
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) simd = st.FindMin();
+    double simdTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double elems = (double)len * reps / 1e9;
+    cout << name << ": scalar " << elems / scalarTime << " Gelem/s, FindMin " << elems / simdTime << " Gelem/s"
+         << (scalar == simd ? "" : " (results differ)") << "\n";
+}
+
+// FindMinAll по мультистеку из многих подстеков: последовательно и на нескольких потоках
+static void RunAll(int stacks, int perStack, int threads)
+{
+    TMultiStack<int> ms(stacks, stacks * perStack);
+    unsigned seed = 777;
+    for (int i = 0; i < stacks; i++)
+        for (int j = 0; j < perStack; j++) {
+            seed = seed * 1664525 + 1013904223;
+            ms.Push(i, (int)(seed >> 4));
+        }
+    double times[2];
+    int totals[2];
+    int threadCounts[2] = { 1, threads };
+    for (int k = 0; k < 2; k++) {
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < 20; r++) totals[k] = ms.FindMinAll(threadCounts[k]).total;
+        times[k] = chrono::duration<double>(chrono::steady_clock::now() - start).count() / 20;
+    }
+    cout << "FindMinAll " << stacks << " x " << perStack << ": 1 thread " << times[0] * 1e3 << " ms, "
+         << threads << " threads " << times[1] * 1e3 << " ms" << (totals[0] == totals[1] ? "" : " (results differ)") << "\n";
+}
+
+// FindMin на стеке, лежащем в кэше (по умолчанию 16K элементов), против скалярного цикла
+int main(int argc, char** argv)
+{
+    int len = argc > 1 ? atoi(argv[1]) : 16384;
+    int reps = argc > 2 ? atoi(argv[2]) : 20000;
+    cout << "isa: " << SimdMinIsa() << ", len: " << len << "\n";
+    Run<int32_t>("int32 ", len, reps);
+    Run<int64_t>("int64 ", len, reps);
+    Run<float>("float ", len, reps);
+    Run<double>("double", len, reps);
+    RunAll(4096, 4096, argc > 3 ? atoi(argv[3]) : (int)thread::hardware_concurrency());
+    return 0;
+}
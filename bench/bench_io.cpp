@@ -0,0 +1,65 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "TMultiStack.h"
+
+using namespace std;
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Запись и чтение двоичного снимка (по умолчанию 100M int) разными бэкендами:
+// std::ofstream/ifstream против пула pwrite и io_uring, с O_DIRECT и без.
+// Чтение без O_DIRECT идет из страничного кэша, который наполнила запись
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 100000000;
+    string name = argc > 2 ? argv[2] : "bench_io.bin";
+    int depth = argc > 3 ? atoi(argv[3]) : 32;
+
+    TStack<int> st(count);
+    for (int i = 0; i < count; i++) st.Push(i);
+    double mb = (double)count * sizeof(int) / (1 << 20);
+    cout << "io_uring available: " << (IsIoUringAvailable() ? "yes" : "no") << "\n";
+
+    struct TCase
+    {
+        const char* name;
+        TIoBackend backend;
+        bool direct;
+    };
+    TCase cases[] = {
+        { "ofstream        ", TIoBackend::Stream, false },
+        { "pwrite          ", TIoBackend::Pwrite, false },
+        { "pwrite+O_DIRECT ", TIoBackend::Pwrite, true },
+        { "io_uring        ", TIoBackend::IoUring, false },
+        { "io_uring+DIRECT ", TIoBackend::IoUring, true },
+    };
+    for (const TCase& c : cases) {
+        TIoOptions io;
+        io.backend = c.backend;
+        io.direct = c.direct;
+        io.queueDepth = depth;
+
+        auto start = chrono::steady_clock::now();
+        st.SaveToFile(name, TFileFormat::Binary, io);
+        double save = Seconds(start);
+
+        TStack<int> loaded;
+        start = chrono::steady_clock::now();
+        loaded.LoadFromFile(name, io);
+        double load = Seconds(start);
+        if (!(loaded == st)) {
+            cerr << "mismatch for " << c.name << "\n";
+            return 1;
+        }
+        cout << c.name << " save " << save << " s (" << mb / save << " MB/s), load " << load << " s ("
+             << mb / load << " MB/s)\n";
+    }
+    remove(name.c_str());
+    return 0;
+}
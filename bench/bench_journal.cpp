@@ -0,0 +1,39 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "TJournal.h"
+
+using namespace std;
+
+// Push/Pop с журналом при разных размерах кадра и частоте fsync
+int main(int argc, char** argv)
+{
+    int ops = argc > 1 ? atoi(argv[1]) : 1000000;
+    string path = argc > 2 ? argv[2] : "bench_journal";
+    int groups[] = { 1, 64, 1024 };
+    int syncs[] = { 1, 16, 0 };
+    for (int g : groups)
+        for (int s : syncs) {
+            remove((path + ".snap").c_str());
+            remove((path + ".journal").c_str());
+            TJournalOptions opt;
+            opt.groupSize = g;
+            opt.syncEvery = s;
+            int n = g == 1 && s == 1 ? ops / 100 : ops;
+            auto start = chrono::steady_clock::now();
+            {
+                TJournaledStack<long long> st(path, opt);
+                for (int i = 0; i < n; i++) {
+                    if (i % 4 == 3) st.Pop();
+                    else st.Push(i);
+                }
+            }
+            double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "groupSize " << g << ", syncEvery " << s << ": " << n / t / 1e6 << " Mops/s\n";
+        }
+    remove((path + ".snap").c_str());
+    remove((path + ".journal").c_str());
+    return 0;
+}
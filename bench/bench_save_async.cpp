@@ -0,0 +1,48 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "TMultiStack.h"
+
+using namespace std;
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Сколько стоит сохранение стека (по умолчанию 100M int) потоку-владельцу:
+// синхронный SaveToFile против SaveAsync, пока владелец продолжает Push/Pop
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 100000000;
+    string name = argc > 2 ? argv[2] : "bench_save_async.bin";
+
+    TStack<int> st(count + 1024);
+    for (int i = 0; i < count; i++) st.Push(i);
+
+    auto start = chrono::steady_clock::now();
+    st.SaveToFile(name);
+    cout << "SaveToFile: owner blocked " << Seconds(start) << " s\n";
+
+    TSaveMode modes[] = { TSaveMode::Fork, TSaveMode::Thread };
+    const char* names[] = { "fork  ", "thread" };
+    for (int k = 0; k < 2; k++) {
+        start = chrono::steady_clock::now();
+        TSaveHandle h = st.SaveAsync(name, modes[k]);
+        double stall = Seconds(start);
+        long long ops = 0;
+        while (!h.IsDone()) {
+            for (int i = 0; i < 1024; i++) st.Push(i);
+            for (int i = 0; i < 1024; i++) st.Pop();
+            ops += 2048;
+        }
+        h.Wait();
+        double total = Seconds(start);
+        cout << "SaveAsync " << names[k] << ": owner blocked " << stall << " s, save took " << total
+             << " s, owner did " << ops / total / 1e6 << " Mops/s meanwhile\n";
+    }
+    remove(name.c_str());
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TMultiStack.h"
+#include "TShardedStack.h"
+
+using namespace std;
+
+// Обход полного двоичного дерева глубины depth в стиле DFS: задача - глубина узла,
+// обработка узла кладет в пул двух потомков. pending - число еще не обработанных задач
+template <class PushF, class PopF>
+double Run(int threads, int depth, PushF push, PopF pop) {
+    atomic<long long> pending(1);
+    push(0, depth);
+    vector<thread> pool;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            int d;
+            while (pending.load(memory_order_acquire) > 0) {
+                if (!pop(t, d)) {
+                    this_thread::yield();
+                    continue;
+                }
+                if (d > 0) {
+                    pending.fetch_add(2, memory_order_relaxed);
+                    push(t, d - 1);
+                    push(t, d - 1);
+                }
+                pending.fetch_sub(1, memory_order_release);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return ((2LL << depth) - 1) / sec / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = argc > 1 ? atoi(argv[1]) : 64;
+    int depth = argc > 2 ? atoi(argv[2]) : 20;
+
+    cout << "threads\tmutex+TStack\tTShardedStack  (Mtasks/s)\n";
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        TStack<int> st(1024);
+        st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+        mutex m;
+        double locked = Run(threads, depth,
+            [&](int, int v) { lock_guard<mutex> g(m); st.Push(v); },
+            [&](int, int& v) {
+                lock_guard<mutex> g(m);
+                if (st.IsEmpty()) return false;
+                v = st.Pop();
+                return true;
+            });
+
+        TShardedStack<int> ss(threads, 1024 * threads);
+        double sharded = Run(threads, depth,
+            [&](int t, int v) { ss.Push(t, v); },
+            [&](int t, int& v) { return ss.TryPop(t, v); });
+        cout << threads << "\t" << locked << "\t\t" << sharded << "\n";
+    }
+    return 0;
+}
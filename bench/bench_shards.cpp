@@ -0,0 +1,35 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "TMultiStack.h"
+
+using namespace std;
+
+// Снимок мультистека (по умолчанию 1000 подстеков по 100K int) в 1..maxShards файлах
+int main(int argc, char** argv)
+{
+    int stacks = argc > 1 ? atoi(argv[1]) : 1000;
+    int perStack = argc > 2 ? atoi(argv[2]) : 100000;
+    int maxShards = argc > 3 ? atoi(argv[3]) : 8;
+    string name = argc > 4 ? argv[4] : "bench_shards.manifest";
+
+    TMultiStack<int> ms(stacks, stacks * perStack);
+    for (int i = 0; i < stacks; i++)
+        for (int j = 0; j < perStack; j++) ms.Push(i, i ^ j);
+
+    for (int shards = 1; shards <= maxShards; shards *= 2) {
+        auto start = chrono::steady_clock::now();
+        ms.SaveToFile(name, shards);
+        double save = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        TMultiStack<int> loaded;
+        start = chrono::steady_clock::now();
+        loaded.LoadFromFile(name);
+        double load = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << shards << " shards: save " << save << " s, load " << load << " s" << (loaded == ms ? "" : " (differs)") << "\n";
+        remove(name.c_str());
+        for (int k = 0; k < shards; k++) remove((name + "." + to_string(k)).c_str());
+    }
+    return 0;
+}
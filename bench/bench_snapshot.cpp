@@ -0,0 +1,83 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include "TMultiStack.h"
+
+using namespace std;
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Сохранение и загрузка стека int: двоичный снимок (по умолчанию 100M элементов)
+// и его отображение в память против текстового формата (на первых textCount элементах)
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 100000000;
+    int textCount = argc > 2 ? atoi(argv[2]) : 10000000;
+    string dir = argc > 3 ? argv[3] : ".";
+    if (textCount > count) textCount = count;
+
+    TStack<int> st(count);
+    for (int i = 0; i < count; i++) st.Push(i ^ 0x5a5a5a);
+
+    string bin = dir + "/bench_snapshot.bin";
+    auto start = chrono::steady_clock::now();
+    st.SaveToFile(bin);
+    double binSave = Seconds(start);
+    TStack<int> loaded;
+    start = chrono::steady_clock::now();
+    loaded.LoadFromFile(bin);
+    double binLoad = Seconds(start);
+    bool ok = loaded == st;
+    TStack<int> mapped;
+    start = chrono::steady_clock::now();
+    mapped.MapFile(bin, TMapMode::ReadOnly);
+    double binMap = Seconds(start);
+    ok = ok && mapped == st;
+    remove(bin.c_str());
+
+    TStack<int> small(textCount);
+    for (int i = 0; i < textCount; i++) small.Push(i ^ 0x5a5a5a);
+    string txt = dir + "/bench_snapshot.txt";
+    start = chrono::steady_clock::now();
+    small.SaveToFile(txt, TFileFormat::Text);
+    double txtSave = Seconds(start);
+    start = chrono::steady_clock::now();
+    loaded.LoadFromFile(txt);
+    double txtLoad = Seconds(start);
+    ok = ok && loaded == small;
+    remove(txt.c_str());
+
+    // Сжатые форматы на монотонной последовательности с малыми шагами
+    TStack<int> mono(count);
+    for (int i = 0; i < count; i++) mono.Push(i * 2 + (i & 3));
+    TFileFormat codecs[] = { TFileFormat::Binary, TFileFormat::DeltaVarint, TFileFormat::FrameOfReference };
+    const char* codecNames[] = { "raw  ", "delta", "for  " };
+    for (int k = 0; k < 3; k++) {
+        start = chrono::steady_clock::now();
+        mono.SaveToFile(bin, codecs[k]);
+        double save = Seconds(start);
+        ifstream f(bin, ios::binary | ios::ate);
+        long long size = (long long)f.tellg();
+        f.close();
+        start = chrono::steady_clock::now();
+        loaded.LoadFromFile(bin);
+        double load = Seconds(start);
+        ok = ok && loaded == mono;
+        remove(bin.c_str());
+        cout << "monotonic " << codecNames[k] << ": " << size / 1e6 << " MB, save " << save << " s, load " << load << " s\n";
+    }
+
+    cout << "binary, " << count << " elements: save " << binSave << " s, load " << binLoad << " s, map " << binMap << " s\n";
+    cout << "text,   " << textCount << " elements: save " << txtSave << " s, load " << txtLoad << " s\n";
+    if (!ok) {
+        cout << "loaded stack differs\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include "TMultiStack.h"
+
+using namespace std;
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Текстовый вывод и ввод стека (по умолчанию 10M int и double): operator<< и operator>>
+// через to_chars/from_chars против поэлементного форматирования iostream
+template <class T>
+static void Run(const char* name, int count)
+{
+    TStack<T> st(count);
+    for (int i = 0; i < count; i++) st.Push((T)(i * 37 % 1000003) / (T)7);
+
+    auto start = chrono::steady_clock::now();
+    ostringstream slow;
+    for (int i = 0; i < count; i++) slow << st.Top() << ", ";
+    double slowOut = Seconds(start);
+
+    start = chrono::steady_clock::now();
+    ostringstream fast;
+    fast << st;
+    double fastOut = Seconds(start);
+
+    string text = to_string(count) + " " + fast.str().substr(fast.str().find(": ") + 2);
+    for (char& c : text)
+        if (c == ',') c = ' ';
+
+    start = chrono::steady_clock::now();
+    istringstream slowIn(text);
+    int len;
+    slowIn >> len;
+    T value, sum = 0;
+    for (int i = 0; i < len && slowIn >> value; i++) sum += value;
+    double slowRead = Seconds(start);
+
+    TStack<T> loaded;
+    start = chrono::steady_clock::now();
+    istringstream fastIn(text);
+    fastIn >> loaded;
+    double fastRead = Seconds(start);
+    if (loaded.GetCount() != count) cerr << "read " << loaded.GetCount() << " of " << count << "\n";
+
+    cout << name << ": write iostream " << slowOut << " s, operator<< " << fastOut << " s; read iostream "
+         << slowRead << " s, operator>> " << fastRead << " s" << (sum < 0 ? " " : "") << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 10000000;
+    Run<int>("int   ", count);
+    Run<double>("double", count);
+    return 0;
+}
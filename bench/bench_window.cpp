@@ -0,0 +1,53 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include "TAggregateQueue.h"
+
+using namespace std;
+
+// Скользящие min/max по потоку событий: очередь на двух агрегирующих стеках
+// против пары монотонных деков
+int main(int argc, char** argv)
+{
+    long long events = argc > 1 ? atoll(argv[1]) : 100000000LL;
+    int window = argc > 2 ? atoi(argv[2]) : 1024;
+
+    unsigned seed = 12345;
+    long long check = 0;
+    auto start = chrono::steady_clock::now();
+    TAggregateQueue<int, TMinOp<int>, TMaxOp<int>> q(2 * window);
+    for (long long i = 0; i < events; i++) {
+        seed = seed * 1664525 + 1013904223;
+        q.Push((int)(seed >> 8));
+        if (q.GetCount() > window) q.Pop();
+        check += q.Aggregate<0>() ^ q.Aggregate<1>();
+    }
+    double twoStacks = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    seed = 12345;
+    long long checkDeque = 0;
+    start = chrono::steady_clock::now();
+    deque<pair<long long, int>> mins, maxs;
+    for (long long i = 0; i < events; i++) {
+        seed = seed * 1664525 + 1013904223;
+        int v = (int)(seed >> 8);
+        while (!mins.empty() && mins.back().second >= v) mins.pop_back();
+        while (!maxs.empty() && maxs.back().second <= v) maxs.pop_back();
+        mins.emplace_back(i, v);
+        maxs.emplace_back(i, v);
+        if (mins.front().first <= i - window) mins.pop_front();
+        if (maxs.front().first <= i - window) maxs.pop_front();
+        checkDeque += mins.front().second ^ maxs.front().second;
+    }
+    double monotonic = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "events: " << events << ", window: " << window << "\n";
+    cout << "two stacks:      " << events / twoStacks / 1e6 << " Mevents/s\n";
+    cout << "monotonic deque: " << events / monotonic / 1e6 << " Mevents/s\n";
+    if (check != checkDeque) {
+        cout << "results differ\n";
+        return 1;
+    }
+    return 0;
+}
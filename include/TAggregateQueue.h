@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "TAggregateStack.h"
+
+// Операция с переставленными аргументами: в переднем стеке очереди элементы лежат
+// в обратном порядке, и так агрегат сохраняет порядок FIFO для некоммутативных операций
+template <class Op>
+struct TFlipOp
+{
+    Op op;
+    template <class T>
+    T operator()(const T& a, const T& b) const { return op(b, a); }
+};
+
+// Очередь FIFO на двух TAggregateStack: Push кладет в задний стек, Pop снимает с переднего,
+// перекладывая в него задний, когда передний пуст (амортизированное O(1)).
+// Aggregate<K>() объединяет агрегаты двух стеков за O(1), что дает агрегат скользящего окна.
+template <class T, class... Ops>
+class TAggregateQueue
+{
+protected:
+    TAggregateStack<T, Ops...> back;
+    TAggregateStack<T, TFlipOp<Ops>...> front;
+    std::tuple<Ops...> ops;
+
+    void Transfer();
+public:
+    TAggregateQueue(int len_ = 0, const TGrowthPolicy& growth = TGrowthPolicy::Geometric());
+
+    int GetCount();
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+
+    void Push(T value);
+    T Pop();
+    const T& Front();
+
+    bool IsEmpty();
+
+    template <std::size_t K = 0>
+    T Aggregate();
+};
+
+template<class T, class... Ops>
+inline TAggregateQueue<T, Ops...>::TAggregateQueue(int len_, const TGrowthPolicy& growth) : back(len_), front(len_), ops() {
+    SetGrowthPolicy(growth);
+}
+
+template<class T, class... Ops>
+inline int TAggregateQueue<T, Ops...>::GetCount() { return back.GetCount() + front.GetCount(); }
+
+template<class T, class... Ops>
+inline void TAggregateQueue<T, Ops...>::SetGrowthPolicy(const TGrowthPolicy& growth_) {
+    back.SetGrowthPolicy(growth_);
+    front.SetGrowthPolicy(growth_);
+}
+
+template<class T, class... Ops>
+inline void TAggregateQueue<T, Ops...>::Transfer() {
+    while (!back.IsEmpty()) front.Push(back.Pop());
+}
+
+template<class T, class... Ops>
+inline void TAggregateQueue<T, Ops...>::Push(T value) { back.Push(std::move(value)); }
+
+template<class T, class... Ops>
+inline T TAggregateQueue<T, Ops...>::Pop() {
+    if (front.IsEmpty()) {
+        if (back.IsEmpty()) throw std::logic_error("queue is empty");
+        Transfer();
+    }
+    return front.Pop();
+}
+
+template<class T, class... Ops>
+inline const T& TAggregateQueue<T, Ops...>::Front() {
+    if (front.IsEmpty()) {
+        if (back.IsEmpty()) throw std::logic_error("queue is empty");
+        Transfer();
+    }
+    return front.Top();
+}
+
+template<class T, class... Ops>
+inline bool TAggregateQueue<T, Ops...>::IsEmpty() { return back.IsEmpty() && front.IsEmpty(); }
+
+template<class T, class... Ops>
+template <std::size_t K>
+inline T TAggregateQueue<T, Ops...>::Aggregate() {
+    if (front.IsEmpty()) return back.template Aggregate<K>();
+    if (back.IsEmpty()) return front.template Aggregate<K>();
+    return std::get<K>(ops)(front.template Aggregate<K>(), back.template Aggregate<K>());
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "TMultiStack.h"
+
+// Ассоциативные операции для TAggregateStack. Нейтральный элемент не нужен:
+// агрегат первого элемента равен ему самому
+template <class T>
+struct TMinOp { T operator()(const T& a, const T& b) const { return b < a ? b : a; } };
+
+template <class T>
+struct TMaxOp { T operator()(const T& a, const T& b) const { return a < b ? b : a; } };
+
+template <class T>
+struct TSumOp { T operator()(const T& a, const T& b) const { return a + b; } };
+
+template <class T>
+struct TXorOp { T operator()(const T& a, const T& b) const { return a ^ b; } };
+
+template <class T>
+struct TGcdOp { T operator()(const T& a, const T& b) const { return std::gcd(a, b); } };
+
+// Стек, в котором с каждым элементом хранится агрегат всех элементов от дна до него
+// по каждой из операций Ops (любые ассоциативные функторы над T). Aggregate<K>() - O(1),
+// Pop просто снимает элемент вместе с его агрегатами.
+template <class T, class... Ops>
+class TAggregateStack
+{
+    static_assert(sizeof...(Ops) > 0, "TAggregateStack requires at least one operation");
+protected:
+    static constexpr std::size_t OpCount = sizeof...(Ops);
+    struct TNode
+    {
+        T value;
+        std::array<T, OpCount> aggregates;
+    };
+    TStack<TNode> stack;
+    std::tuple<Ops...> ops;
+
+    template <std::size_t... K>
+    TNode MakeNode(T&& value, std::index_sequence<K...>);
+
+    template <class Op>
+    static constexpr std::size_t IndexOf() {
+        std::size_t i = 0, res = OpCount;
+        ((std::is_same<Op, Ops>::value && res == OpCount ? (res = i, ++i) : ++i), ...);
+        return res;
+    }
+public:
+    TAggregateStack(int len_ = 0);
+    TAggregateStack(int len_, Ops... ops_);
+
+    int GetLen();
+    int GetCount();
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+
+    void Push(T value);
+    T Pop();
+    const T& Top();
+
+    bool IsEmpty();
+    bool IsFull();
+
+    template <std::size_t K = 0>
+    const T& Aggregate();
+    template <class Op>
+    const T& Aggregate();
+
+    template <class O, class... P>
+    friend std::ostream& operator<<(std::ostream& o, TAggregateStack<O, P...>& v);
+};
+
+template<class T, class... Ops>
+inline TAggregateStack<T, Ops...>::TAggregateStack(int len_) : stack(len_), ops() {}
+
+template<class T, class... Ops>
+inline TAggregateStack<T, Ops...>::TAggregateStack(int len_, Ops... ops_) : stack(len_), ops(std::move(ops_)...) {}
+
+template<class T, class... Ops>
+inline int TAggregateStack<T, Ops...>::GetLen() { return stack.GetLen(); }
+
+template<class T, class... Ops>
+inline int TAggregateStack<T, Ops...>::GetCount() { return stack.GetCount(); }
+
+template<class T, class... Ops>
+inline void TAggregateStack<T, Ops...>::SetGrowthPolicy(const TGrowthPolicy& growth_) { stack.SetGrowthPolicy(growth_); }
+
+template<class T, class... Ops>
+template <std::size_t... K>
+inline typename TAggregateStack<T, Ops...>::TNode TAggregateStack<T, Ops...>::MakeNode(T&& value, std::index_sequence<K...>) {
+    if (stack.IsEmpty()) return TNode{ value, { ((void)K, value)... } };
+    const TNode& prev = stack.Top();
+    return TNode{ value, { std::get<K>(ops)(prev.aggregates[K], value)... } };
+}
+
+template<class T, class... Ops>
+inline void TAggregateStack<T, Ops...>::Push(T value) {
+    stack.Push(MakeNode(std::move(value), std::index_sequence_for<Ops...>()));
+}
+
+template<class T, class... Ops>
+inline T TAggregateStack<T, Ops...>::Pop() { return std::move(stack.Pop().value); }
+
+template<class T, class... Ops>
+inline const T& TAggregateStack<T, Ops...>::Top() { return stack.Top().value; }
+
+template<class T, class... Ops>
+inline bool TAggregateStack<T, Ops...>::IsEmpty() { return stack.IsEmpty(); }
+
+template<class T, class... Ops>
+inline bool TAggregateStack<T, Ops...>::IsFull() { return stack.IsFull(); }
+
+template<class T, class... Ops>
+template <std::size_t K>
+inline const T& TAggregateStack<T, Ops...>::Aggregate() {
+    static_assert(K < OpCount, "operation index out of range");
+    if (stack.IsEmpty()) throw std::logic_error("Cannot aggregate empty stack");
+    return stack.Top().aggregates[K];
+}
+
+template<class T, class... Ops>
+template <class Op>
+inline const T& TAggregateStack<T, Ops...>::Aggregate() { return Aggregate<IndexOf<Op>()>(); }
+
+template<class O, class... P>
+inline std::ostream& operator<<(std::ostream& o, TAggregateStack<O, P...>& v) {
+    int n = v.stack.GetCount();
+    o << "TAggregateStack[len=" << v.stack.GetLen() << ", top=" << n << "]\nData: ";
+    const auto* nodes = v.stack.GetData();
+    for (int i = 0; i < n; i++) o << nodes[i].value << (i < n - 1 ? ", " : "");
+    o << "\n";
+    return o;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+
+// Потоковый (thread_local) список свободных блоков одного размера.
+// Блоки, освобожденные в другом потоке, попадают в список этого потока.
+class TFreeList
+{
+protected:
+    struct TNode { TNode* next; };
+    TNode* head;
+    int size;
+public:
+    TFreeList() : head(nullptr), size(0) {}
+    TFreeList(const TFreeList&) = delete;
+    TFreeList& operator=(const TFreeList&) = delete;
+    ~TFreeList() {
+        while (head) {
+            TNode* next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+
+    void* Get() {
+        if (!head) return nullptr;
+        TNode* node = head;
+        head = head->next;
+        size--;
+        return node;
+    }
+    bool Put(void* p, int maxSize) {
+        if (size >= maxSize) return false;
+        TNode* node = static_cast<TNode*>(p);
+        node->next = head;
+        head = node;
+        size++;
+        return true;
+    }
+    int GetSize() const { return size; }
+};
+
+// Пул блоков ровно по BlockLen элементов: allocate(BlockLen) берет блок из потокового
+// списка свободных, deallocate возвращает его туда (не более MaxFree блоков на поток).
+// Запросы другого размера идут в глобальный operator new. Подходит для TChunkedStack
+// с chunkLen == BlockLen и для TStack фиксированной длины.
+template <class T, std::size_t BlockLen = 1024, int MaxFree = 64>
+class TPoolAllocator
+{
+protected:
+    static constexpr std::size_t BlockBytes =
+        (BlockLen * sizeof(T) > sizeof(void*) ? BlockLen * sizeof(T) : sizeof(void*));
+
+    static TFreeList& Pool() {
+        static thread_local TFreeList pool;
+        return pool;
+    }
+public:
+    typedef T value_type;
+    template <class U>
+    struct rebind { typedef TPoolAllocator<U, BlockLen, MaxFree> other; };
+
+    TPoolAllocator() noexcept {}
+    template <class U>
+    TPoolAllocator(const TPoolAllocator<U, BlockLen, MaxFree>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n == BlockLen) {
+            void* p = Pool().Get();
+            return static_cast<T*>(p ? p : ::operator new(BlockBytes));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n == BlockLen && Pool().Put(p, MaxFree)) return;
+        ::operator delete(p);
+    }
+
+    static int GetFreeCount() { return Pool().GetSize(); }
+
+    template <class U>
+    bool operator==(const TPoolAllocator<U, BlockLen, MaxFree>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const TPoolAllocator<U, BlockLen, MaxFree>&) const noexcept { return false; }
+};
+
+// Монотонная арена: выделение сдвигает указатель, память возвращается только
+// при Reset/разрушении. Освобождение последнего выделенного блока (LIFO) откатывает
+// указатель, поэтому стековая дисциплина Push/Pop переиспользует одну и ту же память.
+// Арена не потокобезопасна.
+class TArena
+{
+protected:
+    struct TBlock
+    {
+        TBlock* prev;
+        std::size_t size;
+    };
+    TBlock* block;
+    char* cur;
+    char* end;
+    std::size_t blockSize;
+    std::size_t used;
+
+    void AddBlock(std::size_t minSize);
+public:
+    TArena(std::size_t blockSize_ = 64 * 1024);
+    TArena(const TArena&) = delete;
+    TArena& operator=(const TArena&) = delete;
+    ~TArena();
+
+    void* Allocate(std::size_t size, std::size_t align);
+    void Deallocate(void* p, std::size_t size);
+    void Reset();
+
+    std::size_t GetUsed() const;
+    int GetBlockCount() const;
+};
+
+template <class T>
+class TArenaAllocator
+{
+protected:
+    TArena* arena;
+
+    template <class U>
+    friend class TArenaAllocator;
+public:
+    typedef T value_type;
+
+    TArenaAllocator(TArena& arena_) noexcept : arena(&arena_) {}
+    template <class U>
+    TArenaAllocator(const TArenaAllocator<U>& obj) noexcept : arena(obj.arena) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, std::size_t n) noexcept { arena->Deallocate(p, n * sizeof(T)); }
+
+    TArena& GetArena() const { return *arena; }
+
+    template <class U>
+    bool operator==(const TArenaAllocator<U>& obj) const noexcept { return arena == obj.arena; }
+    template <class U>
+    bool operator!=(const TArenaAllocator<U>& obj) const noexcept { return arena != obj.arena; }
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "TSnapshot.h"
+
+// Сжатие целых по блокам из CodecBlockLen элементов; каждый блок декодируется независимо.
+// DeltaVarint - разности соседних элементов в zigzag + varint (LEB128),
+// FrameOfReference - минимум блока и смещения от него, упакованные по width бит.
+enum class TBlockCodec : std::uint32_t { Raw = 0, DeltaVarint = 1, FrameOfReference = 2 };
+const int CodecBlockLen = 1 << 16;
+
+// f(0..n-1) на threadCount потоках (0 - по числу ядер); исключение пробрасывается вызывающему
+void ParallelFor(int n, const std::function<void(int)>& f, int threadCount = 0);
+
+template <class T>
+struct THasBlockCodec : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8> {};
+
+// Значение как 64-битное слово: знаковые расширяются знаком, поэтому разность двух
+// слов по модулю 2^64 равна разности значений
+template <class T>
+inline std::uint64_t CodecWord(T v) {
+    return std::is_signed<T>::value ? (std::uint64_t)(std::int64_t)v : (std::uint64_t)v;
+}
+
+inline void PutVarint(std::uint64_t x, std::vector<char>& out) {
+    while (x >= 0x80) {
+        out.push_back((char)(x | 0x80));
+        x >>= 7;
+    }
+    out.push_back((char)x);
+}
+
+inline std::uint64_t GetVarint(const char*& p, const char* end) {
+    std::uint64_t x = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char b = (unsigned char)*p++;
+        x |= (std::uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return x;
+    }
+    throw std::runtime_error("Bad varint in compressed block");
+}
+
+// width бит с позиции bit; буфер дополнен 8 байтами, чтобы читать словом
+inline std::uint64_t GetBits(const unsigned char* p, std::uint64_t bit, int width) {
+    const unsigned char* at = p + bit / 8;
+    int shift = (int)(bit % 8);
+    std::uint64_t w;
+    std::memcpy(&w, at, 8);
+    std::uint64_t x = w >> shift;
+    if (shift + width > 64) x |= (std::uint64_t)at[8] << (64 - shift);
+    return width == 64 ? x : x & ((1ULL << width) - 1);
+}
+
+template <class T>
+void EncodeBlock(TBlockCodec codec, const T* data, int count, std::vector<char>& out) {
+    if (codec == TBlockCodec::DeltaVarint) {
+        std::uint64_t prev = 0;
+        for (int i = 0; i < count; i++) {
+            std::uint64_t cur = CodecWord(data[i]);
+            std::uint64_t d = cur - prev;
+            PutVarint((d << 1) ^ (std::uint64_t)((std::int64_t)d >> 63), out);
+            prev = cur;
+        }
+        return;
+    }
+    if (codec != TBlockCodec::FrameOfReference) throw std::invalid_argument("unknown block codec");
+    T lo = *std::min_element(data, data + count), hi = *std::max_element(data, data + count);
+    std::uint64_t base = CodecWord(lo), range = CodecWord(hi) - base;
+    int width = 0;
+    while (width < 64 && (range >> width) != 0) width++;
+    std::size_t at = out.size();
+    std::size_t packed = ((std::size_t)count * width + 7) / 8;
+    out.resize(at + 9 + packed + 8, 0);
+    std::memcpy(&out[at], &base, 8);
+    out[at + 8] = (char)width;
+    if (width == 0) return;
+    // Слова заполняются по порядку; последнее неполное слово попадает в дополнение
+    char* q = &out[at + 9];
+    std::uint64_t acc = 0;
+    int accBits = 0;
+    for (int i = 0; i < count; i++) {
+        std::uint64_t x = CodecWord(data[i]) - base;
+        acc |= x << accBits;
+        if (accBits + width >= 64) {
+            std::memcpy(q, &acc, 8);
+            q += 8;
+            acc = accBits ? x >> (64 - accBits) : 0;
+            accBits += width - 64;
+        }
+        else accBits += width;
+    }
+    std::memcpy(q, &acc, 8);
+}
+
+template <class T>
+void DecodeBlock(TBlockCodec codec, const char* in, std::size_t bytes, T* data, int count) {
+    const char* end = in + bytes;
+    if (codec == TBlockCodec::DeltaVarint) {
+        std::uint64_t prev = 0;
+        for (int i = 0; i < count; i++) {
+            std::uint64_t z = GetVarint(in, end);
+            prev += (z >> 1) ^ (0 - (z & 1));
+            data[i] = (T)prev;
+        }
+        if (in != end) throw std::runtime_error("Bad compressed block length");
+        return;
+    }
+    if (codec != TBlockCodec::FrameOfReference) throw std::runtime_error("Unknown block codec");
+    if (bytes < 9) throw std::runtime_error("Bad compressed block length");
+    std::uint64_t base;
+    std::memcpy(&base, in, 8);
+    int width = (unsigned char)in[8];
+    if (width > 64 || bytes != 9 + ((std::size_t)count * width + 7) / 8 + 8)
+        throw std::runtime_error("Bad compressed block length");
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in + 9);
+    for (int i = 0; i < count; i++)
+        data[i] = (T)(base + (width ? GetBits(p, (std::uint64_t)i * width, width) : 0));
+}
+
+// Сжатый снимок (версия 2): заголовок с кодеком в flags и контрольной суммой исходных данных,
+// таблица смещений блоков (blockCount + 1 слов) и блоки. Блоки кодируются параллельно
+template <class T>
+void WriteCompressedSnapshot(const std::string& filename, TBlockCodec codec, const T* data, int count, int capacity) {
+    static_assert(THasBlockCodec<T>::value, "compressed snapshots require integral T");
+    int blockCount = (count + CodecBlockLen - 1) / CodecBlockLen;
+    std::vector<std::vector<char>> blocks(blockCount);
+    ParallelFor(blockCount, [&](int b) {
+        int n = std::min(CodecBlockLen, count - b * CodecBlockLen);
+        blocks[b].reserve((std::size_t)n * 2);
+        EncodeBlock(codec, data + (std::size_t)b * CodecBlockLen, n, blocks[b]);
+    });
+    std::vector<std::uint64_t> offsets(blockCount + 1, 0);
+    for (int b = 0; b < blockCount; b++) offsets[b + 1] = offsets[b] + blocks[b].size();
+
+    TSnapshotHeader header = MakeSnapshotHeader(sizeof(T), count, capacity, data);
+    header.version = 2;
+    header.flags = (std::uint32_t)codec;
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), (std::streamsize)(offsets.size() * 8));
+    for (auto& block : blocks) file.write(block.data(), (std::streamsize)block.size());
+    if (!file) throw std::runtime_error("Cannot write file: " + filename);
+}
+
+// Читает блоки после заголовка сжатого снимка в data (header.count элементов) и декодирует их параллельно
+template <class T>
+void ReadCompressedSnapshot(std::istream& in, const TSnapshotHeader& header, T* data) {
+    static_assert(THasBlockCodec<T>::value, "compressed snapshots require integral T");
+    TBlockCodec codec = (TBlockCodec)header.flags;
+    int count = (int)header.count;
+    int blockCount = (count + CodecBlockLen - 1) / CodecBlockLen;
+    std::vector<std::uint64_t> offsets(blockCount + 1);
+    in.read(reinterpret_cast<char*>(offsets.data()), (std::streamsize)(offsets.size() * 8));
+    if (!in || offsets[0] != 0) throw std::runtime_error("Bad compressed snapshot index");
+    for (int b = 0; b < blockCount; b++)
+        if (offsets[b + 1] < offsets[b]) throw std::runtime_error("Bad compressed snapshot index");
+    // Размер блоков берется из файла: до выделения буфера он сверяется с остатком файла
+    std::streampos dataStart = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::uint64_t rest = (std::uint64_t)(in.tellg() - dataStart);
+    in.seekg(dataStart);
+    if (dataStart < 0 || offsets[blockCount] > rest) throw std::runtime_error("Compressed snapshot is truncated");
+    std::vector<char> buf((std::size_t)offsets[blockCount]);
+    in.read(buf.data(), (std::streamsize)buf.size());
+    if (!in) throw std::runtime_error("Compressed snapshot is truncated");
+    ParallelFor(blockCount, [&](int b) {
+        int n = std::min(CodecBlockLen, count - b * CodecBlockLen);
+        DecodeBlock(codec, buf.data() + offsets[b], (std::size_t)(offsets[b + 1] - offsets[b]),
+                    data + (std::size_t)b * CodecBlockLen, n);
+    });
+    CheckSnapshotData(header, data);
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <locale>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+
+// Типы, которые std::from_chars/std::to_chars читают и пишут так же, как потоки:
+// целые (кроме bool и символьных, которые потоки читают как символ) и вещественные
+template <class T>
+struct THasCharsConv : std::integral_constant<bool,
+    (std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+     !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+     !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value) ||
+    std::is_floating_point<T>::value> {};
+
+inline bool IsCharsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Разбирает один токен целиком; ведущий '+' допускается, как в operator>>
+template <class T>
+bool ParseChars(const char* first, const char* last, T& value) {
+    if (first < last && *first == '+') first++;
+    std::from_chars_result r = std::from_chars(first, last, value);
+    return r.ec == std::errc() && r.ptr == last;
+}
+
+// Читает из потока числа, разделенные пробельными символами, блоками по BlockLen байт
+// и передает каждое в f. Останавливается в конце потока или на первом неразобранном токене.
+template <class T, class F>
+void ReadNumbers(std::istream& in, F f) {
+    const std::size_t BlockLen = 1 << 16;
+    std::size_t cap = BlockLen, begin = 0, end = 0;
+    std::unique_ptr<char[]> buf(new char[cap]);
+    bool eof = false;
+    for (;;) {
+        while (begin < end && IsCharsSpace(buf[begin])) begin++;
+        std::size_t tokenEnd = begin;
+        while (tokenEnd < end && !IsCharsSpace(buf[tokenEnd])) tokenEnd++;
+        if (tokenEnd == end && !eof) {
+            // Токен может продолжаться в следующем блоке: остаток переносится в начало буфера
+            std::memmove(buf.get(), buf.get() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+            if (end == cap) {
+                std::unique_ptr<char[]> bigger(new char[cap * 2]);
+                std::memcpy(bigger.get(), buf.get(), end);
+                buf = std::move(bigger);
+                cap *= 2;
+            }
+            in.read(buf.get() + end, (std::streamsize)(cap - end));
+            end += (std::size_t)in.gcount();
+            if (!in) eof = true;
+            continue;
+        }
+        if (begin == tokenEnd) return;
+        T value;
+        if (!ParseChars(buf.get() + begin, buf.get() + tokenEnd, value)) return;
+        f(value);
+        begin = tokenEnd;
+    }
+}
+
+// Поток печатает и читает числа так же, как to_chars/from_chars: десятичная система,
+// без группировки разрядов, десятичная точка '.'
+inline bool IsPlainNumberStream(const std::ios_base& s) {
+    if ((s.flags() & std::ios_base::basefield) != std::ios_base::dec) return false;
+    const std::numpunct<char>& punct = std::use_facet<std::numpunct<char>>(s.getloc());
+    return punct.grouping().empty() && punct.decimal_point() == '.';
+}
+
+// Флаги, при которых вывод to_chars совпадает с operator<<: без ширины, showpos,
+// а для вещественных еще без showpoint, uppercase и hexfloat (формат %g, %f или %e с точностью потока)
+template <class T>
+bool CanWriteChars(const std::ostream& o) {
+    if (o.width() != 0 || (o.flags() & std::ios_base::showpos) || !IsPlainNumberStream(o)) return false;
+    if constexpr (std::is_floating_point<T>::value) {
+        std::ios_base::fmtflags f = o.flags();
+        if ((f & (std::ios_base::showpoint | std::ios_base::uppercase)) || o.precision() < 0) return false;
+        return (f & std::ios_base::floatfield) != std::ios_base::floatfield;
+    }
+    return true;
+}
+
+// nullptr, если число не помещается в [first, last)
+template <class T>
+char* WriteChars(char* first, char* last, T value, const std::ostream& o) {
+    std::to_chars_result r;
+    if constexpr (std::is_floating_point<T>::value) {
+        std::ios_base::fmtflags field = o.flags() & std::ios_base::floatfield;
+        std::chars_format fmt = field == std::ios_base::fixed ? std::chars_format::fixed
+            : field == std::ios_base::scientific ? std::chars_format::scientific : std::chars_format::general;
+        r = std::to_chars(first, last, value, fmt, (int)o.precision());
+    }
+    else r = std::to_chars(first, last, value);
+    return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+// Пишет n чисел через sep блоками по BlockLen байт. false (и ничего не пишет),
+// если флаги потока не позволяют форматировать через to_chars
+template <class T>
+bool WriteNumbers(std::ostream& o, const T* data, int n, const char* sep) {
+    if (!CanWriteChars<T>(o)) return false;
+    const std::size_t BlockLen = 1 << 16;
+    std::unique_ptr<char[]> buf(new char[BlockLen]);
+    char* end = buf.get() + BlockLen;
+    char* p = buf.get();
+    std::size_t sepLen = std::strlen(sep);
+    for (int i = 0; i < n; i++) {
+        if (i > 0) {
+            if ((std::size_t)(end - p) < sepLen) {
+                o.write(buf.get(), p - buf.get());
+                p = buf.get();
+            }
+            std::memcpy(p, sep, sepLen);
+            p += sepLen;
+        }
+        char* next = WriteChars(p, end, data[i], o);
+        if (!next) {
+            o.write(buf.get(), p - buf.get());
+            p = buf.get();
+            next = WriteChars(p, end, data[i], o);
+            // Длиннее блока бывает только fixed с огромной точностью
+            if (!next) {
+                o << data[i];
+                continue;
+            }
+        }
+        p = next;
+    }
+    o.write(buf.get(), p - buf.get());
+    return true;
+}
+
+// Читает одно число прямо из streambuf, без sentry и num_get: пропускает пробельные символы,
+// собирает символы числа и разбирает их from_chars. Состояние потока выставляется как у operator>>.
+// Поток должен быть IsPlainNumberStream и со skipws
+template <class T>
+bool ReadChars(std::istream& in, T& value) {
+    if (!in.good()) {
+        in.setstate(std::ios_base::failbit);
+        return false;
+    }
+    std::streambuf* sb = in.rdbuf();
+    const int Eof = std::char_traits<char>::eof();
+    int c = sb->sgetc();
+    while (c != Eof && IsCharsSpace((char)c)) c = sb->snextc();
+
+    const std::size_t MaxLen = 128;
+    char buf[MaxLen];
+    std::size_t n = 0;
+    while (c != Eof && n < MaxLen) {
+        bool sign = c == '+' || c == '-';
+        bool ok = (c >= '0' && c <= '9') || (sign && n == 0);
+        if constexpr (std::is_floating_point<T>::value)
+            ok = ok || c == '.' || c == 'e' || c == 'E' || (sign && (buf[n - 1] == 'e' || buf[n - 1] == 'E'));
+        if (!ok) break;
+        buf[n++] = (char)c;
+        c = sb->snextc();
+    }
+    if (c == Eof) in.setstate(std::ios_base::eofbit);
+
+    bool ok;
+    // Как и operator>>, беззнаковые принимают минус и берут значение по модулю 2^N
+    if constexpr (std::is_unsigned<T>::value) {
+        bool negative = n > 0 && buf[0] == '-';
+        ok = ParseChars(buf + negative, buf + n, value) && !(negative && n > 1 && buf[1] == '+');
+        if (ok && negative) value = (T)(T(0) - value);
+    }
+    else ok = ParseChars(buf, buf + n, value);
+    if (!ok) in.setstate(std::ios_base::failbit);
+    return ok;
+}
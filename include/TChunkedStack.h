@@ -0,0 +1,239 @@
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <new>
+#include <memory>
+#include <utility>
+#include "TSimdMin.h"
+
+// Стек из блоков фиксированного размера: рост добавляет блок и никогда не перемещает
+// уже лежащие элементы, поэтому указатели на них остаются действительными до Pop.
+template <class T, class Alloc = std::allocator<T>>
+class TChunkedStack
+{
+protected:
+    T** chunks;
+    int chunkCap;
+    int chunkCount;
+    int chunkLen;
+    int count;
+    T* begin;
+    T* cur;
+    T* end;
+    Alloc alloc;
+
+    void NextChunk();
+    void PrevChunk();
+    void ReleaseChunks(int from);
+    void Clear();
+public:
+    TChunkedStack(int chunkLen_ = 1024, const Alloc& alloc_ = Alloc());
+    TChunkedStack(const TChunkedStack& obj);
+    TChunkedStack(TChunkedStack&& obj);
+    ~TChunkedStack();
+
+    Alloc GetAllocator() const;
+
+    int GetCount();
+    int GetChunkLen();
+    int GetChunkCount();
+
+    void Push(T value);
+    T Pop();
+    void ShrinkToFit();
+
+    bool IsEmpty();
+
+    T& operator[](int i);
+    TChunkedStack& operator=(const TChunkedStack<T, Alloc>& obj);
+    TChunkedStack& operator=(TChunkedStack<T, Alloc>&& obj);
+    bool operator==(const TChunkedStack<T, Alloc>& obj);
+    bool operator!=(const TChunkedStack<T, Alloc>& obj);
+
+    template <class O, class A>
+    friend std::ostream& operator<<(std::ostream& o, TChunkedStack<O, A>& v);
+
+    T FindMin() const;
+};
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>::TChunkedStack(int chunkLen_, const Alloc& alloc_) : chunks(nullptr), chunkCap(0), chunkCount(0),
+    chunkLen(chunkLen_), count(0), begin(nullptr), cur(nullptr), end(nullptr), alloc(alloc_) {
+    if (chunkLen_ <= 0) throw std::invalid_argument("chunkLen <= 0");
+}
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>::TChunkedStack(const TChunkedStack& obj)
+    : TChunkedStack(obj.chunkLen, std::allocator_traits<Alloc>::select_on_container_copy_construction(obj.alloc)) {
+    for (int i = 0; i < obj.count; i++) Push(obj.chunks[i / chunkLen][i % chunkLen]);
+}
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>::TChunkedStack(TChunkedStack&& obj) : alloc(obj.alloc) {
+    chunks = obj.chunks; chunkCap = obj.chunkCap; chunkCount = obj.chunkCount; chunkLen = obj.chunkLen;
+    count = obj.count; begin = obj.begin; cur = obj.cur; end = obj.end;
+
+    obj.chunks = nullptr; obj.chunkCap = obj.chunkCount = obj.count = 0;
+    obj.begin = obj.cur = obj.end = nullptr;
+}
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>::~TChunkedStack() { Clear(); }
+
+template<class T, class Alloc>
+inline Alloc TChunkedStack<T, Alloc>::GetAllocator() const { return alloc; }
+
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::Clear() {
+    while (count > 0) Pop();
+    ReleaseChunks(0);
+    delete[] chunks;
+    chunks = nullptr; chunkCap = 0;
+    begin = cur = end = nullptr;
+}
+
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::ReleaseChunks(int from) {
+    for (int i = from; i < chunkCount; i++) std::allocator_traits<Alloc>::deallocate(alloc, chunks[i], chunkLen);
+    if (from < chunkCount) chunkCount = from;
+}
+
+// Переход к следующему блоку; каталог блоков растет удвоением, копируются только указатели
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::NextChunk() {
+    int idx = count / chunkLen;
+    if (idx == chunkCount) {
+        if (chunkCount == chunkCap) {
+            int newCap = chunkCap > 0 ? chunkCap * 2 : 4;
+            T** newChunks = new T * [newCap];
+            for (int i = 0; i < chunkCount; i++) newChunks[i] = chunks[i];
+            delete[] chunks;
+            chunks = newChunks;
+            chunkCap = newCap;
+        }
+        chunks[chunkCount] = std::allocator_traits<Alloc>::allocate(alloc, chunkLen);
+        chunkCount++;
+    }
+    begin = cur = chunks[idx];
+    end = begin + chunkLen;
+}
+
+// Возврат к предыдущему блоку; один освободившийся блок остается в запасе,
+// чтобы чередование Push/Pop на границе не гоняло аллокатор
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::PrevChunk() {
+    int idx = count / chunkLen - 1;
+    ReleaseChunks(idx + 2);
+    begin = chunks[idx];
+    cur = end = begin + chunkLen;
+}
+
+template<class T, class Alloc>
+inline int TChunkedStack<T, Alloc>::GetCount() { return count; }
+
+template<class T, class Alloc>
+inline int TChunkedStack<T, Alloc>::GetChunkLen() { return chunkLen; }
+
+template<class T, class Alloc>
+inline int TChunkedStack<T, Alloc>::GetChunkCount() { return chunkCount; }
+
+template<class T, class Alloc>
+inline bool TChunkedStack<T, Alloc>::IsEmpty() { return count == 0; }
+
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::Push(T value) {
+    if (cur == end) NextChunk();
+    new (cur) T(std::move(value));
+    cur++;
+    count++;
+}
+
+template<class T, class Alloc>
+inline T TChunkedStack<T, Alloc>::Pop() {
+    if (IsEmpty()) throw std::logic_error("stack is empty");
+    if (cur == begin) PrevChunk();
+    cur--;
+    count--;
+    T val = std::move(*cur);
+    cur->~T();
+    return val;
+}
+
+template<class T, class Alloc>
+inline void TChunkedStack<T, Alloc>::ShrinkToFit() {
+    if (count > 0 && cur == begin) {
+        begin = chunks[count / chunkLen - 1];
+        cur = end = begin + chunkLen;
+    }
+    ReleaseChunks((count + chunkLen - 1) / chunkLen);
+    if (count == 0) begin = cur = end = nullptr;
+}
+
+template<class T, class Alloc>
+inline T& TChunkedStack<T, Alloc>::operator[](int i) {
+    if (i < 0 || i >= count) throw std::out_of_range("index out of range");
+    return chunks[i / chunkLen][i % chunkLen];
+}
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>& TChunkedStack<T, Alloc>::operator=(const TChunkedStack<T, Alloc>& obj) {
+    if (this == &obj) return *this;
+    TChunkedStack<T, Alloc> tmp(obj);
+    return *this = std::move(tmp);
+}
+
+template<class T, class Alloc>
+inline TChunkedStack<T, Alloc>& TChunkedStack<T, Alloc>::operator=(TChunkedStack<T, Alloc>&& obj) {
+    if (this == &obj) return *this;
+
+    Clear();
+
+    chunks = obj.chunks; chunkCap = obj.chunkCap; chunkCount = obj.chunkCount; chunkLen = obj.chunkLen;
+    count = obj.count; begin = obj.begin; cur = obj.cur; end = obj.end; alloc = obj.alloc;
+
+    obj.chunks = nullptr; obj.chunkCap = obj.chunkCount = obj.count = 0;
+    obj.begin = obj.cur = obj.end = nullptr;
+
+    return *this;
+}
+
+template<class T, class Alloc>
+inline bool TChunkedStack<T, Alloc>::operator==(const TChunkedStack<T, Alloc>& obj) {
+    if (count != obj.count) return false;
+    for (int i = 0; i < count; i++)
+        if (chunks[i / chunkLen][i % chunkLen] != obj.chunks[i / obj.chunkLen][i % obj.chunkLen]) return false;
+    return true;
+}
+
+template<class T, class Alloc>
+inline bool TChunkedStack<T, Alloc>::operator!=(const TChunkedStack<T, Alloc>& obj) { return !(*this == obj); }
+
+template<class O, class A>
+inline std::ostream& operator<<(std::ostream& o, TChunkedStack<O, A>& v) {
+    o << "TChunkedStack[chunkLen=" << v.chunkLen << ", chunks=" << v.chunkCount << ", top=" << v.count << "]\nData: ";
+    for (int i = 0; i < v.count; i++) o << v.chunks[i / v.chunkLen][i % v.chunkLen] << (i < v.count - 1 ? ", " : "");
+    o << "\n";
+    return o;
+}
+
+template<class T, class Alloc>
+T TChunkedStack<T, Alloc>::FindMin() const {
+    if (count == 0) throw std::logic_error("Cannot find min in empty stack");
+    T minValue = chunks[0][0];
+    for (int c = 0; c * chunkLen < count; c++) {
+        int n = std::min(chunkLen, count - c * chunkLen);
+        if constexpr (THasSimdMin<T>::value) {
+            // NaN в начале блока дал бы NaN для всего блока; такой блок проходится скалярно
+            T cm = SimdMin(chunks[c], n);
+            if (cm == cm) {
+                if (cm < minValue) minValue = cm;
+                continue;
+            }
+        }
+        for (int i = 0; i < n; i++)
+            if (chunks[c][i] < minValue) minValue = chunks[c][i];
+    }
+    return minValue;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <cstdint>
+#include "THazardPointers.h"
+
+// Lock-free стек Трайбера: Push и Pop меняют вершину через CAS. Снятые узлы
+// освобождаются через указатели опасности, поэтому узел не может быть удален
+// или переиспользован, пока другой поток читает его (нет ABA и use-after-free).
+//
+// При eliminationSize > 0 перед стеком ставится массив исключения (elimination backoff,
+// Hendler, Shavit, Yerushalmi, 2004): после неудачного CAS Push оставляет узел в случайной
+// ячейке массива и ждет до backoffSpins итераций, а Pop в это время пытается забрать
+// узел из ячейки. Встретившиеся Push и Pop обмениваются значением, не трогая вершину.
+template <class T>
+class TConcurrentStack
+{
+protected:
+    struct TNode
+    {
+        T value;
+        TNode* next;
+    };
+    struct alignas(64) TSlot
+    {
+        std::atomic<TNode*> node;
+    };
+    std::atomic<TNode*> head;
+    TSlot* slots;
+    int slotCount;
+    int backoffSpins;
+
+    static void DeleteNode(void* p) { delete static_cast<TNode*>(p); }
+    static unsigned NextRandom();
+    bool EliminatePush(TNode* node);
+    bool EliminatePop(T& value);
+public:
+    TConcurrentStack(int eliminationSize = 0, int backoffSpins_ = 256);
+    TConcurrentStack(const TConcurrentStack&) = delete;
+    TConcurrentStack& operator=(const TConcurrentStack&) = delete;
+    ~TConcurrentStack();
+
+    void Push(T value);
+    T Pop();
+    bool TryPop(T& value);
+
+    bool IsEmpty();
+    int GetEliminationSize();
+};
+
+template<class T>
+inline TConcurrentStack<T>::TConcurrentStack(int eliminationSize, int backoffSpins_)
+    : head(nullptr), slots(nullptr), slotCount(0), backoffSpins(backoffSpins_) {
+    if (eliminationSize < 0) throw std::invalid_argument("eliminationSize < 0");
+    if (backoffSpins_ < 0) throw std::invalid_argument("backoffSpins < 0");
+    if (eliminationSize > 0) {
+        slots = new TSlot[eliminationSize];
+        for (int i = 0; i < eliminationSize; i++) slots[i].node.store(nullptr, std::memory_order_relaxed);
+        slotCount = eliminationSize;
+    }
+}
+
+template<class T>
+inline TConcurrentStack<T>::~TConcurrentStack() {
+    TNode* node = head.load(std::memory_order_relaxed);
+    while (node) {
+        TNode* next = node->next;
+        delete node;
+        node = next;
+    }
+    for (int i = 0; i < slotCount; i++) delete slots[i].node.load(std::memory_order_relaxed);
+    delete[] slots;
+}
+
+template<class T>
+inline unsigned TConcurrentStack<T>::NextRandom() {
+    static thread_local unsigned state = 2463534242u ^ (unsigned)(reinterpret_cast<std::uintptr_t>(&state) >> 4);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Узел выставляется в ячейку; если за время ожидания его забрал Pop, обмен состоялся
+template<class T>
+inline bool TConcurrentStack<T>::EliminatePush(TNode* node) {
+    TSlot& slot = slots[NextRandom() % slotCount];
+    TNode* expected = nullptr;
+    if (!slot.node.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_relaxed))
+        return false;
+    for (int i = 0; i < backoffSpins; i++)
+        if (slot.node.load(std::memory_order_relaxed) != node) return true;
+    expected = node;
+    return !slot.node.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed, std::memory_order_relaxed);
+}
+
+// Pop не ждет в ячейке сам, а опрашивает случайные ячейки в пределах backoffSpins
+template<class T>
+inline bool TConcurrentStack<T>::EliminatePop(T& value) {
+    for (int i = 0; i < backoffSpins; i++) {
+        TSlot& slot = slots[NextRandom() % slotCount];
+        TNode* node = slot.node.load(std::memory_order_relaxed);
+        if (node && slot.node.compare_exchange_strong(node, nullptr, std::memory_order_acquire, std::memory_order_relaxed)) {
+            value = std::move(node->value);
+            delete node;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class T>
+inline void TConcurrentStack<T>::Push(T value) {
+    TNode* node = new TNode{ std::move(value), head.load(std::memory_order_relaxed) };
+    if (!slots) {
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+        return;
+    }
+    while (!head.compare_exchange_strong(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        if (EliminatePush(node)) return;
+}
+
+template<class T>
+inline bool TConcurrentStack<T>::TryPop(T& value) {
+    THazardRecord* rec = THazardPointers::Get();
+    for (;;) {
+        TNode* node = THazardPointers::Protect(rec, 0, head);
+        if (!node) {
+            THazardPointers::Clear(rec, 0);
+            return false;
+        }
+        TNode* next = node->next;
+        if (head.compare_exchange_strong(node, next, std::memory_order_acquire, std::memory_order_relaxed)) {
+            THazardPointers::Clear(rec, 0);
+            value = std::move(node->value);
+            THazardPointers::Retire(rec, node, DeleteNode);
+            return true;
+        }
+        if (slots && EliminatePop(value)) {
+            THazardPointers::Clear(rec, 0);
+            return true;
+        }
+    }
+}
+
+template<class T>
+inline T TConcurrentStack<T>::Pop() {
+    T value;
+    if (!TryPop(value)) throw std::logic_error("stack is empty");
+    return value;
+}
+
+template<class T>
+inline bool TConcurrentStack<T>::IsEmpty() { return head.load(std::memory_order_acquire) == nullptr; }
+
+template<class T>
+inline int TConcurrentStack<T>::GetEliminationSize() { return slotCount; }
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "TMultiStack.h"
+
+// Flat combining (Hendler, Incze, Shavit, Tzafrir, 2010) поверх последовательного TStack:
+// поток публикует запрос Push/Pop в ячейке списка публикаций, а поток, захвативший
+// блокировку, становится комбайнером и выполняет пачкой все опубликованные запросы.
+// Внутри одного прохода встречные Push и Pop сокращаются без обращения к стеку.
+template <class T>
+class TFlatCombiningStack
+{
+protected:
+    enum { Free, Claimed, Pending, Done };
+    struct alignas(64) TRequest
+    {
+        std::atomic<int> state;
+        bool push;
+        bool ok;
+        T value;
+        std::exception_ptr error;
+    };
+    TStack<T> stack;
+    TRequest* requests;
+    int requestCount;
+    alignas(64) std::atomic<bool> locked;
+
+    int Claim();
+    void Combine();
+    void Lock();
+    void Unlock();
+    bool Execute(int slot);
+public:
+    TFlatCombiningStack(int slotCount = 64, int len_ = 1024, const TGrowthPolicy& growth = TGrowthPolicy::Geometric());
+    TFlatCombiningStack(const TFlatCombiningStack&) = delete;
+    TFlatCombiningStack& operator=(const TFlatCombiningStack&) = delete;
+    ~TFlatCombiningStack();
+
+    int GetCount();
+
+    void Push(T value);
+    T Pop();
+    bool TryPop(T& value);
+
+    bool IsEmpty();
+};
+
+template<class T>
+inline TFlatCombiningStack<T>::TFlatCombiningStack(int slotCount, int len_, const TGrowthPolicy& growth)
+    : stack(len_), requests(nullptr), requestCount(0), locked(false) {
+    if (slotCount <= 0) throw std::invalid_argument("slotCount <= 0");
+    stack.SetGrowthPolicy(growth);
+    requests = new TRequest[slotCount];
+    for (int i = 0; i < slotCount; i++) requests[i].state.store(Free, std::memory_order_relaxed);
+    requestCount = slotCount;
+}
+
+template<class T>
+inline TFlatCombiningStack<T>::~TFlatCombiningStack() { delete[] requests; }
+
+template<class T>
+inline void TFlatCombiningStack<T>::Lock() {
+    while (locked.exchange(true, std::memory_order_acquire))
+        while (locked.load(std::memory_order_relaxed)) std::this_thread::yield();
+}
+
+template<class T>
+inline void TFlatCombiningStack<T>::Unlock() { locked.store(false, std::memory_order_release); }
+
+// Ячейка публикации: поток начинает поиск со своей, запомненной с прошлого раза
+template<class T>
+inline int TFlatCombiningStack<T>::Claim() {
+    static thread_local unsigned hint = (unsigned)std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (;;) {
+        for (int k = 0; k < requestCount; k++) {
+            int i = (int)((hint + k) % requestCount);
+            int expected = Free;
+            if (requests[i].state.load(std::memory_order_relaxed) == Free &&
+                requests[i].state.compare_exchange_strong(expected, Claimed, std::memory_order_acquire)) {
+                hint = i;
+                return i;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+template<class T>
+inline void TFlatCombiningStack<T>::Combine() {
+    int pendingPush = -1;
+    for (int i = 0; i < requestCount; i++) {
+        TRequest& r = requests[i];
+        if (r.state.load(std::memory_order_acquire) != Pending) continue;
+        if (r.push) {
+            if (pendingPush >= 0) {
+                TRequest& p = requests[pendingPush];
+                try { stack.Push(std::move(p.value)); p.ok = true; }
+                catch (...) { p.error = std::current_exception(); }
+                p.state.store(Done, std::memory_order_release);
+            }
+            pendingPush = i;
+            continue;
+        }
+        if (pendingPush >= 0) {
+            TRequest& p = requests[pendingPush];
+            r.value = std::move(p.value);
+            r.ok = p.ok = true;
+            p.state.store(Done, std::memory_order_release);
+            pendingPush = -1;
+        }
+        else if (!stack.IsEmpty()) {
+            r.value = stack.Pop();
+            r.ok = true;
+        }
+        else r.ok = false;
+        r.state.store(Done, std::memory_order_release);
+    }
+    if (pendingPush >= 0) {
+        TRequest& p = requests[pendingPush];
+        try { stack.Push(std::move(p.value)); p.ok = true; }
+        catch (...) { p.error = std::current_exception(); }
+        p.state.store(Done, std::memory_order_release);
+    }
+}
+
+// Ждет выполнения своего запроса, при свободной блокировке выполняет чужие сам
+template<class T>
+inline bool TFlatCombiningStack<T>::Execute(int slot) {
+    TRequest& r = requests[slot];
+    r.ok = false;
+    r.error = nullptr;
+    r.state.store(Pending, std::memory_order_release);
+    while (r.state.load(std::memory_order_acquire) != Done) {
+        if (!locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire)) {
+            Combine();
+            Unlock();
+        }
+        else std::this_thread::yield();
+    }
+    return r.ok;
+}
+
+template<class T>
+inline void TFlatCombiningStack<T>::Push(T value) {
+    int slot = Claim();
+    TRequest& r = requests[slot];
+    r.push = true;
+    r.value = std::move(value);
+    Execute(slot);
+    std::exception_ptr error = std::move(r.error);
+    r.state.store(Free, std::memory_order_release);
+    if (error) std::rethrow_exception(error);
+}
+
+template<class T>
+inline bool TFlatCombiningStack<T>::TryPop(T& value) {
+    int slot = Claim();
+    TRequest& r = requests[slot];
+    r.push = false;
+    bool ok = Execute(slot);
+    if (ok) value = std::move(r.value);
+    r.state.store(Free, std::memory_order_release);
+    return ok;
+}
+
+template<class T>
+inline T TFlatCombiningStack<T>::Pop() {
+    T value;
+    if (!TryPop(value)) throw std::logic_error("stack is empty");
+    return value;
+}
+
+template<class T>
+inline int TFlatCombiningStack<T>::GetCount() {
+    Lock();
+    int res = stack.GetCount();
+    Unlock();
+    return res;
+}
+
+template<class T>
+inline bool TFlatCombiningStack<T>::IsEmpty() { return GetCount() == 0; }
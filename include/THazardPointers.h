@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <utility>
+
+// Указатели опасности (hazard pointers, M. Michael, 2004) для безопасного освобождения
+// узлов в lock-free структурах. У каждого потока своя запись с HazardSlots ячейками;
+// узел, снятый со структуры, передается в Retire и удаляется только тогда,
+// когда ни одна ячейка ни одного потока на него не указывает.
+const int HazardSlots = 2;
+
+struct THazardRecord
+{
+    std::atomic<void*> hazard[HazardSlots];
+    std::atomic<bool> active;
+    THazardRecord* next;
+    std::vector<std::pair<void*, void (*)(void*)>> retired;
+};
+
+class THazardPointers
+{
+public:
+    static THazardRecord* Get();
+    static void Retire(THazardRecord* rec, void* p, void (*deleter)(void*));
+    static void Scan(THazardRecord* rec);
+
+    // Публикует src в ячейке slot так, чтобы значение не могло быть освобождено
+    template <class T>
+    static T* Protect(THazardRecord* rec, int slot, const std::atomic<T*>& src) {
+        T* p = src.load(std::memory_order_relaxed);
+        for (;;) {
+            rec->hazard[slot].store(p, std::memory_order_seq_cst);
+            T* q = src.load(std::memory_order_seq_cst);
+            if (q == p) return p;
+            p = q;
+        }
+    }
+
+    static void Clear(THazardRecord* rec, int slot) {
+        rec->hazard[slot].store(nullptr, std::memory_order_release);
+    }
+};
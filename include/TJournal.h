@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "TMultiStack.h"
+#include "TSnapshot.h"
+
+// Журнал операций: 32-байтный заголовок и кадры. Кадр - одна групповая фиксация:
+// заголовок кадра (сигнатура, длина, контрольная сумма) и записи "op [значение]".
+// Поколение связывает журнал со снимком, к которому он применяется.
+struct TJournalHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t elemSize;
+    std::uint64_t generation;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(TJournalHeader) == 32, "journal header must be 32 bytes");
+
+struct TJournalFrame
+{
+    std::uint32_t magic;
+    std::uint32_t bytes;
+    std::uint64_t checksum;
+};
+static_assert(sizeof(TJournalFrame) == 16, "journal frame header must be 16 bytes");
+
+// Файл журнала (только POSIX): дописывание кадров одним write() и fsync.
+// Недописанный или испорченный хвост после сбоя отбрасывается при открытии.
+class TJournalFile
+{
+protected:
+    std::string path;
+    int fd;
+    std::uint32_t elemSize;
+    std::uint64_t generation;
+    std::uint64_t syncCount;
+
+    void Create(std::uint64_t generation_);
+public:
+    TJournalFile(const std::string& path_, std::uint32_t elemSize_);
+    TJournalFile(const TJournalFile&) = delete;
+    TJournalFile& operator=(const TJournalFile&) = delete;
+    ~TJournalFile();
+
+    // Открывает журнал поколения generation_ и возвращает записи всех целых кадров.
+    // Журнал более старого поколения (сбой во время сжатия) пересоздается пустым
+    void Open(std::uint64_t generation_, std::vector<char>& records);
+    // frame начинается с sizeof(TJournalFrame) свободных байт под заголовок кадра
+    void Append(char* frame, std::size_t bytes);
+    void Sync();
+    // Атомарно заменяет журнал пустым журналом нового поколения
+    void Reset(std::uint64_t generation_);
+
+    std::uint64_t GetGeneration() const { return generation; }
+    // Сколько раз журнал был сброшен на диск через Sync
+    std::uint64_t GetSyncCount() const { return syncCount; }
+};
+
+struct TJournalOptions
+{
+    int groupSize;    // операций в одном кадре; при заполнении кадр фиксируется сам
+    int syncEvery;    // fsync после каждых syncEvery кадров; 0 - только в Sync и Compact
+    int compactEvery; // операций в журнале до автоматического сжатия; 0 - только вручную
+
+    TJournalOptions() : groupSize(64), syncEvery(1), compactEvery(0) {}
+};
+
+// Стек с журналом упреждающей записи: Push и Pop копятся в кадре и дописываются в
+// path.journal групповой фиксацией (Commit). Compact пишет полный снимок path.snap
+// и начинает пустой журнал следующего поколения. Конструктор восстанавливает стек
+// из снимка и журнала. Операции, не дошедшие до Commit, при сбое теряются,
+// а не дошедшие до fsync - могут потеряться при сбое системы.
+template <class T>
+class TJournaledStack
+{
+    static_assert(std::is_trivially_copyable<T>::value, "TJournaledStack requires trivially copyable T");
+protected:
+    enum : char { OpPush = 1, OpPop = 2 };
+    TStack<T> stack;
+    std::string path;
+    TJournalOptions options;
+    TJournalFile journal;
+    std::vector<char> frame;
+    int frameOps;
+    int unsynced;     // кадров после последнего fsync
+    long long journalOps;
+
+    void Recover();
+    void Replay(const std::vector<char>& records);
+public:
+    TJournaledStack(const std::string& path_, const TJournalOptions& options_ = TJournalOptions(),
+                    const TGrowthPolicy& growth = TGrowthPolicy::Geometric());
+    TJournaledStack(const TJournaledStack&) = delete;
+    TJournaledStack& operator=(const TJournaledStack&) = delete;
+    ~TJournaledStack();
+
+    int GetCount();
+    long long GetJournalCount() const;
+    std::uint64_t GetGeneration() const;
+    std::uint64_t GetSyncCount() const;
+
+    void Push(T value);
+    T Pop();
+    const T& Top();
+    bool IsEmpty();
+
+    void Commit();
+    void Sync();
+    void Compact();
+};
+
+template<class T>
+inline TJournaledStack<T>::TJournaledStack(const std::string& path_, const TJournalOptions& options_, const TGrowthPolicy& growth)
+    : path(path_), options(options_), journal(path_ + ".journal", sizeof(T)), frameOps(0), unsynced(0), journalOps(0) {
+    if (options.groupSize <= 0) throw std::invalid_argument("groupSize <= 0");
+    if (options.syncEvery < 0) throw std::invalid_argument("syncEvery < 0");
+    if (options.compactEvery < 0) throw std::invalid_argument("compactEvery < 0");
+    stack.SetGrowthPolicy(growth);
+    frame.resize(sizeof(TJournalFrame));
+    Recover();
+}
+
+// Незафиксированный кадр дописывается и сбрасывается на диск; ошибки здесь не выбрасываются
+template<class T>
+inline TJournaledStack<T>::~TJournaledStack() {
+    try { Sync(); }
+    catch (...) {}
+}
+
+template<class T>
+inline void TJournaledStack<T>::Recover() {
+    std::uint64_t generation = 0;
+    std::ifstream file(path + ".snap", std::ios::binary);
+    if (file.is_open()) {
+        TSnapshotHeader header;
+        if (!ReadSnapshotHeader(file, header)) throw std::runtime_error("Not a snapshot: " + path + ".snap");
+        file.close();
+        generation = header.generation;
+        TGrowthPolicy growth = stack.GetGrowthPolicy();
+        stack.LoadFromFile(path + ".snap");
+        stack.SetGrowthPolicy(growth);
+    }
+    std::vector<char> records;
+    journal.Open(generation, records);
+    Replay(records);
+}
+
+template<class T>
+inline void TJournaledStack<T>::Replay(const std::vector<char>& records) {
+    std::size_t i = 0;
+    while (i < records.size()) {
+        char op = records[i++];
+        if (op == OpPush && i + sizeof(T) <= records.size()) {
+            T value;
+            std::memcpy(&value, records.data() + i, sizeof(T));
+            i += sizeof(T);
+            stack.Push(value);
+        }
+        else if (op == OpPop && !stack.IsEmpty()) stack.Pop();
+        else throw std::runtime_error("Corrupted journal: " + path + ".journal");
+        journalOps++;
+    }
+}
+
+template<class T>
+inline int TJournaledStack<T>::GetCount() { return stack.GetCount(); }
+
+template<class T>
+inline long long TJournaledStack<T>::GetJournalCount() const { return journalOps + frameOps; }
+
+template<class T>
+inline std::uint64_t TJournaledStack<T>::GetGeneration() const { return journal.GetGeneration(); }
+
+template<class T>
+inline std::uint64_t TJournaledStack<T>::GetSyncCount() const { return journal.GetSyncCount(); }
+
+template<class T>
+inline bool TJournaledStack<T>::IsEmpty() { return stack.IsEmpty(); }
+
+template<class T>
+inline const T& TJournaledStack<T>::Top() { return stack.Top(); }
+
+template<class T>
+inline void TJournaledStack<T>::Push(T value) {
+    stack.Push(value);
+    std::size_t at = frame.size();
+    frame.resize(at + 1 + sizeof(T));
+    frame[at] = OpPush;
+    std::memcpy(frame.data() + at + 1, &value, sizeof(T));
+    if (++frameOps >= options.groupSize) Commit();
+}
+
+template<class T>
+inline T TJournaledStack<T>::Pop() {
+    T value = stack.Pop();
+    frame.push_back(OpPop);
+    if (++frameOps >= options.groupSize) Commit();
+    return value;
+}
+
+template<class T>
+inline void TJournaledStack<T>::Commit() {
+    if (frameOps == 0) return;
+    journal.Append(frame.data(), frame.size());
+    frame.resize(sizeof(TJournalFrame));
+    journalOps += frameOps;
+    frameOps = 0;
+    unsynced++;
+    if (options.syncEvery > 0 && unsynced >= options.syncEvery) {
+        journal.Sync();
+        unsynced = 0;
+    }
+    if (options.compactEvery > 0 && journalOps >= options.compactEvery) Compact();
+}
+
+template<class T>
+inline void TJournaledStack<T>::Sync() {
+    Commit();
+    if (unsynced > 0) {
+        journal.Sync();
+        unsynced = 0;
+    }
+}
+
+// Снимок нового поколения пишется до замены журнала: после сбоя между ними
+// старый журнал распознается по поколению и отбрасывается
+template<class T>
+inline void TJournaledStack<T>::Compact() {
+    Sync();
+    std::uint64_t generation = journal.GetGeneration() + 1;
+    int n = stack.GetCount();
+    const T* data = stack.GetData();
+    TSnapshotHeader header = MakeSnapshotHeader(sizeof(T), n, stack.GetLen(), data);
+    header.generation = generation;
+    WriteSnapshotFile(path + ".snap", header, data, true);
+    journal.Reset(generation);
+    journalOps = 0;
+}
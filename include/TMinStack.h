@@ -0,0 +1,178 @@
+#pragma once
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "TMultiStack.h"
+
+// Стек с FindMin за O(1): рядом с основным хранится вспомогательный стек минимумов.
+// Значение кладется в него, если оно не больше текущего минимума, и снимается вместе
+// с равным ему значением основного стека, так что Pop восстанавливает прежний минимум.
+// Вспомогательный стек никогда не длиннее основного, поэтому его емкости всегда хватает.
+template <class T, class Alloc = std::allocator<T>>
+class TMinStack
+{
+protected:
+    TStack<T, Alloc> values;
+    TStack<T, Alloc> mins;
+public:
+    TMinStack(int len_ = 0, const Alloc& alloc_ = Alloc());
+
+    int GetLen();
+    int GetCount();
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+
+    void Push(T value);
+    T Pop();
+    T& Top();
+
+    bool IsEmpty();
+    bool IsFull();
+
+    bool operator==(const TMinStack& obj);
+    bool operator!=(const TMinStack& obj);
+
+    template <class O, class A>
+    friend std::ostream& operator<<(std::ostream& o, TMinStack<O, A>& v);
+
+    const T& FindMin();
+};
+
+template<class T, class Alloc>
+inline TMinStack<T, Alloc>::TMinStack(int len_, const Alloc& alloc_) : values(len_, alloc_), mins(len_, alloc_) {}
+
+template<class T, class Alloc>
+inline int TMinStack<T, Alloc>::GetLen() { return values.GetLen(); }
+
+template<class T, class Alloc>
+inline int TMinStack<T, Alloc>::GetCount() { return values.GetCount(); }
+
+template<class T, class Alloc>
+inline void TMinStack<T, Alloc>::SetGrowthPolicy(const TGrowthPolicy& growth_) {
+    values.SetGrowthPolicy(growth_);
+    mins.SetGrowthPolicy(growth_);
+}
+
+template<class T, class Alloc>
+inline void TMinStack<T, Alloc>::Push(T value) {
+    bool isMin = mins.IsEmpty() || !(mins.Top() < value);
+    if (isMin) {
+        values.Push(value);
+        mins.Push(std::move(value));
+    }
+    else values.Push(std::move(value));
+}
+
+template<class T, class Alloc>
+inline T TMinStack<T, Alloc>::Pop() {
+    T value = values.Pop();
+    if (!(mins.Top() < value)) mins.Pop();
+    return value;
+}
+
+template<class T, class Alloc>
+inline T& TMinStack<T, Alloc>::Top() { return values.Top(); }
+
+template<class T, class Alloc>
+inline bool TMinStack<T, Alloc>::IsEmpty() { return values.IsEmpty(); }
+
+template<class T, class Alloc>
+inline bool TMinStack<T, Alloc>::IsFull() { return values.IsFull(); }
+
+template<class T, class Alloc>
+inline bool TMinStack<T, Alloc>::operator==(const TMinStack& obj) { return values == obj.values; }
+
+template<class T, class Alloc>
+inline bool TMinStack<T, Alloc>::operator!=(const TMinStack& obj) { return !(*this == obj); }
+
+template<class O, class A>
+inline std::ostream& operator<<(std::ostream& o, TMinStack<O, A>& v) { return o << v.values; }
+
+template<class T, class Alloc>
+inline const T& TMinStack<T, Alloc>::FindMin() {
+    if (mins.IsEmpty()) throw std::logic_error("Cannot find min in empty stack");
+    return mins.Top();
+}
+
+// То же для каждого подстека TMultiStack: минимумы лежат в параллельном TMultiStack
+// с тем же числом подстеков и той же длиной общего буфера
+template <class T, class Alloc = std::allocator<T>>
+class TMinMultiStack
+{
+protected:
+    TMultiStack<T, Alloc> values;
+    TMultiStack<T, Alloc> mins;
+public:
+    TMinMultiStack(int count_, int len_, const Alloc& alloc_ = Alloc());
+
+    int GetLen();
+    int GetStackCount();
+    int GetCount(int i);
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+
+    void Push(int i, T value);
+    T Pop(int i);
+    T& Top(int i);
+
+    bool IsEmpty(int i);
+    bool IsFull();
+
+    template <class O, class A>
+    friend std::ostream& operator<<(std::ostream& o, TMinMultiStack<O, A>& v);
+
+    const T& FindMin(int i);
+};
+
+template<class T, class Alloc>
+inline TMinMultiStack<T, Alloc>::TMinMultiStack(int count_, int len_, const Alloc& alloc_)
+    : values(count_, len_, alloc_), mins(count_, len_, alloc_) {}
+
+template<class T, class Alloc>
+inline int TMinMultiStack<T, Alloc>::GetLen() { return values.GetLen(); }
+
+template<class T, class Alloc>
+inline int TMinMultiStack<T, Alloc>::GetStackCount() { return values.GetStackCount(); }
+
+template<class T, class Alloc>
+inline int TMinMultiStack<T, Alloc>::GetCount(int i) { return values.GetCount(i); }
+
+template<class T, class Alloc>
+inline void TMinMultiStack<T, Alloc>::SetGrowthPolicy(const TGrowthPolicy& growth_) {
+    values.SetGrowthPolicy(growth_);
+    mins.SetGrowthPolicy(growth_);
+}
+
+template<class T, class Alloc>
+inline void TMinMultiStack<T, Alloc>::Push(int i, T value) {
+    bool isMin = mins.IsEmpty(i) || !(mins.Top(i) < value);
+    if (isMin) {
+        values.Push(i, value);
+        mins.Push(i, std::move(value));
+    }
+    else values.Push(i, std::move(value));
+}
+
+template<class T, class Alloc>
+inline T TMinMultiStack<T, Alloc>::Pop(int i) {
+    T value = values.Pop(i);
+    if (!(mins.Top(i) < value)) mins.Pop(i);
+    return value;
+}
+
+template<class T, class Alloc>
+inline T& TMinMultiStack<T, Alloc>::Top(int i) { return values.Top(i); }
+
+template<class T, class Alloc>
+inline bool TMinMultiStack<T, Alloc>::IsEmpty(int i) { return values.IsEmpty(i); }
+
+template<class T, class Alloc>
+inline bool TMinMultiStack<T, Alloc>::IsFull() { return values.IsFull(); }
+
+template<class O, class A>
+inline std::ostream& operator<<(std::ostream& o, TMinMultiStack<O, A>& v) { return o << v.values; }
+
+template<class T, class Alloc>
+inline const T& TMinMultiStack<T, Alloc>::FindMin(int i) {
+    if (mins.IsEmpty(i)) throw std::logic_error("Cannot find min in empty stack");
+    return mins.Top(i);
+}
@@ -4,300 +4,1079 @@
 #include <stdexcept>
 #include <vector>
 #include <fstream>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <climits>
+#include <memory>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include "TBlockCodec.h"
+#include "TCharsConv.h"
+#include "TSaveAsync.h"
+#include "TSimdMin.h"
+#include "TSnapshot.h"
+#include "TSnapshotIo.h"
 
+// Есть ли у T операторы << и >> для потоков: без них текстовый формат недоступен
+template <class T, class = void>
+struct THasStreamOut : std::false_type {};
 template <class T>
+struct THasStreamOut<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type {};
+
+template <class T, class = void>
+struct THasStreamIn : std::false_type {};
+template <class T>
+struct THasStreamIn<T, std::void_t<decltype(std::declval<std::istream&>() >> std::declval<T&>())>> : std::true_type {};
+
+enum class TGrowthKind { None, Geometric, Increment, Capped, Custom };
+
+// Политика роста буфера при переполнении. Geometric и Capped дают амортизированное O(1) на Push,
+// Increment растет на фиксированный шаг, Custom вызывает пользовательскую функцию.
+class TGrowthPolicy
+{
+protected:
+    TGrowthKind kind;
+    double factor;
+    int step;
+    int maxLen;
+    int (*custom)(int len, int required);
+public:
+    TGrowthPolicy() : kind(TGrowthKind::None), factor(1.0), step(0), maxLen(INT_MAX), custom(nullptr) {}
+
+    static TGrowthPolicy None() { return TGrowthPolicy(); }
+    static TGrowthPolicy Geometric(double factor_ = 2.0) {
+        if (factor_ <= 1.0) throw std::invalid_argument("factor <= 1");
+        TGrowthPolicy p;
+        p.kind = TGrowthKind::Geometric; p.factor = factor_;
+        return p;
+    }
+    static TGrowthPolicy Increment(int step_) {
+        if (step_ <= 0) throw std::invalid_argument("step <= 0");
+        TGrowthPolicy p;
+        p.kind = TGrowthKind::Increment; p.step = step_;
+        return p;
+    }
+    static TGrowthPolicy Capped(int maxLen_, double factor_ = 2.0) {
+        if (maxLen_ < 0) throw std::invalid_argument("maxLen < 0");
+        TGrowthPolicy p = Geometric(factor_);
+        p.kind = TGrowthKind::Capped; p.maxLen = maxLen_;
+        return p;
+    }
+    static TGrowthPolicy Custom(int (*custom_)(int len, int required)) {
+        if (!custom_) throw std::invalid_argument("custom == nullptr");
+        TGrowthPolicy p;
+        p.kind = TGrowthKind::Custom; p.custom = custom_;
+        return p;
+    }
+
+    TGrowthKind GetKind() const { return kind; }
+
+    // Новая длина буфера не меньше required либо -1, если расти нельзя
+    int NextLen(int len, int required) const {
+        long long next;
+        switch (kind) {
+        case TGrowthKind::Geometric:
+        case TGrowthKind::Capped:
+            next = std::max((long long)(len * factor), (long long)len + 1);
+            break;
+        case TGrowthKind::Increment:
+            next = (long long)len + step;
+            break;
+        case TGrowthKind::Custom:
+            next = custom(len, required);
+            break;
+        default:
+            return -1;
+        }
+        next = std::min(std::max(next, (long long)required), (long long)maxLen);
+        return next >= required ? (int)next : -1;
+    }
+};
+
+template <class T, class Alloc = std::allocator<T>>
 class TStack
 {
 protected:
-    T** data;
+    T* data;
     int len;
     bool isNew;
     int top;
+    int highWater;
+    TGrowthPolicy growth;
+    Alloc alloc;
+    std::shared_ptr<TSnapshotMapping> mapping;
+    bool readOnly;
+
+    T* Allocate(int n);
+    void Free();
+    void Grow(int required);
 public:
     TStack();
-    TStack(int len_);
+    explicit TStack(const Alloc& alloc_);
+    TStack(int len_, const Alloc& alloc_ = Alloc());
     TStack(const TStack& obj);
     TStack(TStack&& obj);
-    TStack(T** data_, int len_);
+    TStack(T** data_, int len_, const Alloc& alloc_ = Alloc());
+    TStack(T* data_, int len_, int top_);
     ~TStack();
 
+    Alloc GetAllocator() const;
+
     int GetLen();
     int GetCount();
+    // Элементы от дна к вершине, GetCount() штук
+    const T* GetData() const;
 
     void Resize(int len_);
     void SetData(T** data_, int len_);
+    void SetData(T* data_, int len_, int top_);
+    void MapFile(const std::string& filename, TMapMode mode = TMapMode::CopyOnWrite, bool verify = false);
+    bool IsMapped() const;
+
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+    const TGrowthPolicy& GetGrowthPolicy() const;
+    int GetHighWater();
+    void ResetHighWater();
 
     void Push(T value);
     T Pop();
+    // В режиме ReadOnly неконстантный Top() сначала переносит стек в собственный буфер
+    T& Top();
+    const T& Top() const;
 
     bool IsEmpty();
     bool IsFull();
 
-    TStack& operator=(const TStack<T>& obj);
-    TStack& operator=(TStack<T>&& obj);
-    bool operator==(const TStack<T>& obj);
-    bool operator!=(const TStack<T>& obj);
+    TStack& operator=(const TStack<T, Alloc>& obj);
+    TStack& operator=(TStack<T, Alloc>&& obj);
+    bool operator==(const TStack<T, Alloc>& obj);
+    bool operator!=(const TStack<T, Alloc>& obj);
 
-    template <class O>
-    friend std::ostream& operator<<(std::ostream& o, TStack<O>& v);
-    template <class I>
-    friend std::istream& operator>>(std::istream& i, TStack<I>& v);
+    template <class O, class A>
+    friend std::ostream& operator<<(std::ostream& o, TStack<O, A>& v);
+    template <class I, class A>
+    friend std::istream& operator>>(std::istream& i, TStack<I, A>& v);
+
+    // По умолчанию тривиально копируемые T сохраняются двоичным снимком, остальные - текстом.
+    // LoadFromFile определяет формат по сигнатуре файла. io выбирает бэкенд ввода-вывода
+    // для несжатого двоичного снимка (TSnapshotIo.h)
+    static constexpr TFileFormat DefaultFileFormat =
+        std::is_trivially_copyable<T>::value ? TFileFormat::Binary : TFileFormat::Text;
 
     T FindMin() const;
-    void SaveToFile(const std::string& filename) const;
-    void LoadFromFile(const std::string& filename);
+    void SaveToFile(const std::string& filename, TFileFormat format = DefaultFileFormat, const TIoOptions& io = TIoOptions()) const;
+    void LoadFromFile(const std::string& filename, const TIoOptions& io = TIoOptions());
+    // Двоичный снимок текущего состояния пишется в фоне (TSaveAsync.h);
+    // стек можно менять сразу после возврата
+    TSaveHandle SaveAsync(const std::string& filename, TSaveMode mode = TSaveMode::Auto) const;
 };
 
-template<class T>
-inline TStack<T>::TStack() : data(nullptr), len(0), isNew(true), top(0) {}
+// Элементы хранятся подряд в одном буфере и создаются на месте (placement new).
+// При isNew == false буфер принадлежит вызывающему: стек не освобождает его
+// и не разрушает элементы, оставшиеся в нем на момент отказа от буфера.
+template<class T, class Alloc>
+inline T* TStack<T, Alloc>::Allocate(int n) {
+    return n > 0 ? std::allocator_traits<Alloc>::allocate(alloc, n) : nullptr;
+}
+
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::Free() {
+    if (isNew && data) {
+        for (int i = 0; i < top; i++) data[i].~T();
+        std::allocator_traits<Alloc>::deallocate(alloc, data, len);
+    }
+    data = nullptr; len = top = 0; isNew = true;
+    mapping.reset();
+    readOnly = false;
+}
+
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack() : TStack(Alloc()) {}
 
-template<class T>
-inline TStack<T>::TStack(int len_) : TStack() {
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(const Alloc& alloc_) : data(nullptr), len(0), isNew(true), top(0), highWater(0), alloc(alloc_), readOnly(false) {}
+
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(int len_, const Alloc& alloc_) : TStack(alloc_) {
     if (len_ < 0) throw std::invalid_argument("len < 0");
     if (len_ > 0) {
+        data = Allocate(len_);
         len = len_;
-        data = new T * [len]();
     }
 }
 
-template<class T>
-inline TStack<T>::TStack(const TStack& obj) : TStack() {
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(const TStack& obj)
+    : TStack(std::allocator_traits<Alloc>::select_on_container_copy_construction(obj.alloc)) {
     if (obj.len > 0) {
+        data = Allocate(obj.len);
         len = obj.len;
-        data = new T * [len]();
-        for (int i = 0; i < obj.top; i++) {
-            if (obj.data[i]) data[i] = new T(*obj.data[i]);
-        }
+        for (; top < obj.top; top++) new (data + top) T(obj.data[top]);
     }
-    top = obj.top;
+    highWater = obj.highWater;
+    growth = obj.growth;
 }
 
-template<class T>
-inline TStack<T>::TStack(TStack&& obj) {
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(TStack&& obj) : growth(obj.growth), alloc(obj.alloc), mapping(std::move(obj.mapping)) {
     len = obj.len;
     data = obj.data;
     top = obj.top;
     isNew = obj.isNew;
+    highWater = obj.highWater;
+    readOnly = obj.readOnly;
 
-    obj.len = 0; obj.data = nullptr; obj.top = 0; obj.isNew = true;
+    obj.len = 0; obj.data = nullptr; obj.top = 0; obj.isNew = true; obj.highWater = 0; obj.readOnly = false;
 }
 
-template<class T>
-inline TStack<T>::TStack(T** data_, int len_) : TStack() {
-    if (len_ < 0) throw std::invalid_argument("len < 0");
-    if (len_ > 0) {
-        len = len_;
-        data = data_;
-        isNew = false;
-        top = 0;
-        for (int i = 0; i < len; i++) {
-            if (!data[i]) break;
-            top++;
-        }
-    }
+// Значения из массива указателей (до первого nullptr) копируются в собственный буфер
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(T** data_, int len_, const Alloc& alloc_) : TStack(len_, alloc_) {
+    for (; top < len && data_[top]; top++) new (data + top) T(*data_[top]);
+    highWater = top;
 }
 
-template<class T>
-inline TStack<T>::~TStack() {
-    if (isNew && data) {
-        for (int i = 0; i < len; i++) delete data[i];
-        delete[] data;
-    }
+template<class T, class Alloc>
+inline TStack<T, Alloc>::TStack(T* data_, int len_, int top_) : TStack() {
+    SetData(data_, len_, top_);
 }
 
-template<class T>
-inline int TStack<T>::GetLen() { return len; }
+template<class T, class Alloc>
+inline TStack<T, Alloc>::~TStack() { Free(); }
+
+template<class T, class Alloc>
+inline Alloc TStack<T, Alloc>::GetAllocator() const { return alloc; }
+
+template<class T, class Alloc>
+inline int TStack<T, Alloc>::GetLen() { return len; }
 
-template<class T>
-inline int TStack<T>::GetCount() { return top; }
+template<class T, class Alloc>
+inline int TStack<T, Alloc>::GetCount() { return top; }
 
-template<class T>
-inline void TStack<T>::Resize(int len_) {
+template<class T, class Alloc>
+inline const T* TStack<T, Alloc>::GetData() const { return data; }
+
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::Resize(int len_) {
     if (len_ < 0) throw std::invalid_argument("len < 0");
-    if (len_ == len) return;
+    if (len_ == len && !readOnly) return;
 
     if (len_ == 0) {
-        if (isNew && data) {
-            for (int i = 0; i < len; i++) delete data[i];
-            delete[] data;
-        }
-        data = nullptr; len = top = 0; isNew = true;
+        Free();
         return;
     }
 
-    T** newData = new T * [len_]();
-    int elementsToCopy = std::min(len, len_);
-    for (int i = 0; i < elementsToCopy; i++) newData[i] = data[i];
-
-    if (len_ < len) {
-        for (int i = len_; i < len; i++) delete data[i];
-        top = std::min(top, len_);
+    T* newData = Allocate(len_);
+    int elementsToCopy = std::min(top, len_);
+    int i = 0;
+    try {
+        for (; i < elementsToCopy; i++) {
+            if (isNew) new (newData + i) T(std::move(data[i]));
+            else new (newData + i) T(data[i]);
+        }
+    }
+    catch (...) {
+        while (i > 0) newData[--i].~T();
+        std::allocator_traits<Alloc>::deallocate(alloc, newData, len_);
+        throw;
     }
 
-    if (isNew && data) delete[] data;
+    Free();
+    data = newData; len = len_; top = elementsToCopy;
+}
 
-    data = newData; len = len_; isNew = true;
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::SetData(T** data_, int len_) {
+    if (len_ < 0) throw std::invalid_argument("len < 0");
+    TGrowthPolicy policy = growth;
+    *this = TStack<T, Alloc>(data_, len_, alloc);
+    growth = policy;
 }
 
-template<class T>
-inline void TStack<T>::SetData(T** data_, int len_) {
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::SetData(T* data_, int len_, int top_) {
     if (len_ < 0) throw std::invalid_argument("len < 0");
-    if (isNew && data) {
-        for (int i = 0; i < len; i++) delete data[i];
-        delete[] data;
-    }
+    if (top_ < 0 || top_ > len_) throw std::invalid_argument("top out of range");
+    Free();
     data = len_ > 0 ? data_ : nullptr;
     len = len_;
-    top = 0;
-    for (int i = 0; i < len; i++) {
-        if (!data[i]) break;
-        top++;
-    }
+    top = highWater = top_;
     isNew = false;
 }
 
-template<class T>
-inline bool TStack<T>::IsEmpty() { return top == 0; }
+// Снимок используется как буфер стека без копирования (isNew == false), len == count.
+// Первый Push, которому не хватает места, переносит элементы в собственный буфер и
+// освобождает отображение; в режиме ReadOnly так делают любой Push и неконстантный Top()
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::MapFile(const std::string& filename, TMapMode mode, bool verify) {
+    static_assert(std::is_trivially_copyable<T>::value, "MapFile requires trivially copyable T");
+    static_assert(alignof(T) <= sizeof(TSnapshotHeader), "MapFile requires alignof(T) <= 64");
+    auto m = std::make_shared<TSnapshotMapping>(filename, mode, (std::uint32_t)sizeof(T), (std::uint64_t)INT_MAX, verify);
+    int n = (int)m->GetHeader().count;
+    SetData(static_cast<T*>(m->GetData()), n, n);
+    mapping = std::move(m);
+    readOnly = mode == TMapMode::ReadOnly;
+}
+
+template<class T, class Alloc>
+inline bool TStack<T, Alloc>::IsMapped() const { return mapping != nullptr; }
+
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::SetGrowthPolicy(const TGrowthPolicy& growth_) { growth = growth_; }
+
+template<class T, class Alloc>
+inline const TGrowthPolicy& TStack<T, Alloc>::GetGrowthPolicy() const { return growth; }
+
+template<class T, class Alloc>
+inline int TStack<T, Alloc>::GetHighWater() { return highWater; }
+
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::ResetHighWater() { highWater = top; }
+
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::Grow(int required) {
+    int newLen = growth.NextLen(len, required);
+    if (newLen < 0) throw std::logic_error("stack is full");
+    Resize(newLen);
+}
+
+template<class T, class Alloc>
+inline bool TStack<T, Alloc>::IsEmpty() { return top == 0; }
 
-template<class T>
-inline bool TStack<T>::IsFull() { return top >= len; }
+template<class T, class Alloc>
+inline bool TStack<T, Alloc>::IsFull() { return top >= len; }
 
-template<class T>
-inline void TStack<T>::Push(T value) {
-    if (IsFull()) throw std::logic_error("stack is full");
-    data[top++] = new T(value);
+template<class T, class Alloc>
+inline void TStack<T, Alloc>::Push(T value) {
+    if (IsFull()) Grow(top + 1);
+    else if (readOnly) Resize(len);
+    new (data + top) T(std::move(value));
+    if (++top > highWater) highWater = top;
 }
 
-template<class T>
-inline T TStack<T>::Pop() {
+template<class T, class Alloc>
+inline T TStack<T, Alloc>::Pop() {
     if (IsEmpty()) throw std::logic_error("stack is empty");
     top--;
-    T val = *data[top];
-    delete data[top];
-    data[top] = nullptr;
+    T val = std::move(data[top]);
+    data[top].~T();
     return val;
 }
 
-template<class T>
-inline TStack<T>& TStack<T>::operator=(const TStack<T>& obj) {
-    if (this == &obj) return *this;
-
-    if (isNew && data) {
-        for (int i = 0; i < len; i++) delete data[i];
-        delete[] data;
-    }
+template<class T, class Alloc>
+inline T& TStack<T, Alloc>::Top() {
+    if (IsEmpty()) throw std::logic_error("stack is empty");
+    if (readOnly) Resize(len);
+    return data[top - 1];
+}
 
-    len = obj.len; top = obj.top; isNew = true;
-    if (obj.len > 0) {
-        data = new T * [len];
-        for (int i = 0; i < len; i++)
-            data[i] = obj.data[i] ? new T(*obj.data[i]) : nullptr;
-    }
-    else data = nullptr;
+template<class T, class Alloc>
+inline const T& TStack<T, Alloc>::Top() const {
+    if (top == 0) throw std::logic_error("stack is empty");
+    return data[top - 1];
+}
 
-    return *this;
+template<class T, class Alloc>
+inline TStack<T, Alloc>& TStack<T, Alloc>::operator=(const TStack<T, Alloc>& obj) {
+    if (this == &obj) return *this;
+    TStack<T, Alloc> tmp(obj);
+    return *this = std::move(tmp);
 }
 
-template<class T>
-inline TStack<T>& TStack<T>::operator=(TStack<T>&& obj) {
+template<class T, class Alloc>
+inline TStack<T, Alloc>& TStack<T, Alloc>::operator=(TStack<T, Alloc>&& obj) {
     if (this == &obj) return *this;
 
-    if (isNew && data) {
-        for (int i = 0; i < len; i++) delete data[i];
-        delete[] data;
-    }
+    Free();
 
     len = obj.len; data = obj.data; top = obj.top; isNew = obj.isNew;
+    highWater = obj.highWater; growth = obj.growth; alloc = obj.alloc;
+    mapping = std::move(obj.mapping); readOnly = obj.readOnly;
 
-    obj.len = 0; obj.data = nullptr; obj.top = 0; obj.isNew = true;
+    obj.len = 0; obj.data = nullptr; obj.top = 0; obj.isNew = true; obj.highWater = 0; obj.readOnly = false;
 
     return *this;
 }
 
-template<class T>
-inline bool TStack<T>::operator==(const TStack<T>& obj) {
+template<class T, class Alloc>
+inline bool TStack<T, Alloc>::operator==(const TStack<T, Alloc>& obj) {
     if (top != obj.top) return false;
     for (int i = 0; i < top; i++)
-        if (*data[i] != *obj.data[i]) return false;
+        if (data[i] != obj.data[i]) return false;
     return true;
 }
 
-template<class T>
-inline bool TStack<T>::operator!=(const TStack<T>& obj) { return !(*this == obj); }
+template<class T, class Alloc>
+inline bool TStack<T, Alloc>::operator!=(const TStack<T, Alloc>& obj) { return !(*this == obj); }
 
-template<class O>
-inline std::ostream& operator<<(std::ostream& o, TStack<O>& v) {
+template<class O, class A>
+inline std::ostream& operator<<(std::ostream& o, TStack<O, A>& v) {
     o << "TStack[len=" << v.len << ", top=" << v.top << "]\nData: ";
-    for (int i = 0; i < v.top; i++) o << (v.data[i] ? *v.data[i] : O()) << (i < v.top - 1 ? ", " : "");
+    bool done = false;
+    if constexpr (THasCharsConv<O>::value) done = WriteNumbers(o, v.data, v.top, ", ");
+    if (!done)
+        for (int i = 0; i < v.top; i++) o << v.data[i] << (i < v.top - 1 ? ", " : "");
     o << "\n";
     return o;
 }
 
-template<class I>
-inline std::istream& operator>>(std::istream& i, TStack<I>& v) {
+template<class I, class A>
+inline std::istream& operator>>(std::istream& i, TStack<I, A>& v) {
     int newLen;
     i >> newLen;
-    if (!i.good()) return i;
+    if (i.fail()) return i;
     if (newLen < 0) throw std::invalid_argument("len < 0");
 
-    if (v.isNew && v.data) {
-        for (int j = 0; j < v.len; j++) delete v.data[j];
-        delete[] v.data;
-    }
-
-    v.data = newLen > 0 ? new I * [newLen]() : nullptr;
-    v.len = newLen;
-    v.top = 0;
-    v.isNew = true;
-
-    for (int j = 0; j < newLen && i.good(); j++) {
+    TStack<I, A> tmp(newLen, v.alloc);
+    tmp.growth = v.growth;
+    bool fast = false;
+    if constexpr (THasCharsConv<I>::value) fast = (i.flags() & std::ios_base::skipws) && IsPlainNumberStream(i);
+    for (int j = 0; j < newLen; j++) {
         I value;
-        i >> value;
-        if (i.good()) v.data[j] = new I(value), v.top++;
+        if constexpr (THasCharsConv<I>::value) {
+            if (fast) ReadChars(i, value);
+            else i >> value;
+        }
+        else i >> value;
+        if (i.fail()) break;
+        tmp.Push(std::move(value));
     }
+    v = std::move(tmp);
     return i;
 }
 
-template<class T>
-T TStack<T>::FindMin() const {
+template<class T, class Alloc>
+T TStack<T, Alloc>::FindMin() const {
     if (top == 0) throw std::logic_error("Cannot find min in empty stack");
-    T minValue = *data[0];
+    if constexpr (THasSimdMin<T>::value) return SimdMin(data, top);
+    T minValue = data[0];
     for (int i = 1; i < top; i++)
-        if (*data[i] < minValue) minValue = *data[i];
+        if (data[i] < minValue) minValue = data[i];
     return minValue;
 }
 
-template<class T>
-void TStack<T>::SaveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
-    for (int i = 0; i < top; i++) if (data[i]) file << *data[i] << std::endl;
+template<class T, class Alloc>
+void TStack<T, Alloc>::SaveToFile(const std::string& filename, TFileFormat format, const TIoOptions& io) const {
+    if (format == TFileFormat::Binary) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            TSnapshotHeader header = MakeSnapshotHeader(sizeof(T), top, len, data);
+            if (io.backend != TIoBackend::Stream) {
+                WriteFileRange(filename, &header, sizeof(header), data, (std::size_t)top * sizeof(T), io);
+                return;
+            }
+            std::ofstream file(filename, std::ios::binary);
+            if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data), (std::streamsize)top * sizeof(T));
+            if (!file) throw std::runtime_error("Cannot write file: " + filename);
+            return;
+        }
+        else throw std::invalid_argument("binary format requires trivially copyable T");
+    }
+    if (format == TFileFormat::DeltaVarint || format == TFileFormat::FrameOfReference) {
+        if constexpr (THasBlockCodec<T>::value) {
+            WriteCompressedSnapshot(filename, format == TFileFormat::DeltaVarint ? TBlockCodec::DeltaVarint : TBlockCodec::FrameOfReference,
+                                    data, top, len);
+            return;
+        }
+        else throw std::invalid_argument("compressed formats require integral T");
+    }
+    if constexpr (THasStreamOut<T>::value) {
+        std::ofstream file(filename);
+        if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+        WriteTextHeader(file, top, len);
+        bool done = false;
+        if constexpr (THasCharsConv<T>::value) done = WriteNumbers(file, data, top, "\n");
+        if (done && top > 0) file << '\n';
+        if (!done)
+            for (int i = 0; i < top; i++) file << data[i] << '\n';
+        if (!file) throw std::runtime_error("Cannot write file: " + filename);
+    }
+    else throw std::invalid_argument("text format requires operator<< for T");
 }
 
-template<class T>
-void TStack<T>::LoadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
+template<class T, class Alloc>
+void TStack<T, Alloc>::LoadFromFile(const std::string& filename, const TIoOptions& io) {
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
 
-    if (isNew && data) {
-        for (int i = 0; i < len; i++) delete data[i];
-        delete[] data;
+    TSnapshotHeader header;
+    if (ReadSnapshotHeader(file, header)) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            CheckSnapshotHeader(header, sizeof(T), INT_MAX);
+            // До выделения буфера count сверяется с размером файла: данных (или индекса блоков
+            // сжатого снимка) должно хватать. Емкость capacity применяется после чтения данных
+            std::streampos dataStart = file.tellg();
+            file.seekg(0, std::ios::end);
+            std::uint64_t rest = (std::uint64_t)(file.tellg() - dataStart);
+            file.seekg(dataStart);
+            std::uint64_t need = header.flags != (std::uint32_t)TBlockCodec::Raw
+                ? (header.count + CodecBlockLen - 1) / CodecBlockLen * 8 + 8 : header.count * sizeof(T);
+            if (need > rest) throw std::runtime_error("Snapshot is truncated: " + filename);
+            TStack<T, Alloc> tmp((int)header.count, alloc);
+            tmp.growth = growth;
+            if (header.flags != (std::uint32_t)TBlockCodec::Raw) {
+                if constexpr (THasBlockCodec<T>::value) ReadCompressedSnapshot(file, header, tmp.data);
+                else throw std::runtime_error("compressed snapshot requires integral T");
+            }
+            else {
+                if (io.backend != TIoBackend::Stream)
+                    ReadFileRange(filename, header.headerSize, tmp.data, header.count * sizeof(T), io);
+                else {
+                    file.read(reinterpret_cast<char*>(tmp.data), (std::streamsize)(header.count * sizeof(T)));
+                    if (!file) throw std::runtime_error("Snapshot is truncated: " + filename);
+                }
+                CheckSnapshotData(header, tmp.data);
+            }
+            tmp.top = tmp.highWater = (int)header.count;
+            if (header.capacity > header.count) tmp.Resize((int)header.capacity);
+            *this = std::move(tmp);
+            return;
+        }
+        else throw std::runtime_error("binary snapshot requires trivially copyable T");
+    }
+
+    if constexpr (THasStreamIn<T>::value) {
+        // Текст читается прямо в буфер нового стека, который растет геометрически. Заголовку
+        // не доверяем: буфер заранее выделяется на count, но не больше, чем элементов может
+        // уместиться в остатке файла (не меньше 2 байт на элемент), а емкость capacity
+        // восстанавливается только после того, как прочитано ровно count элементов
+        std::uint64_t count = 0, capacity = 0;
+        ReadTextHeader(file, count, capacity);
+        std::streampos dataStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::uint64_t rest = (std::uint64_t)(file.tellg() - dataStart);
+        file.seekg(dataStart);
+        TStack<T, Alloc> tmp((int)std::min<std::uint64_t>(std::min(count, (rest + 1) / 2), INT_MAX), alloc);
+        tmp.growth = TGrowthPolicy::Geometric();
+        if constexpr (THasCharsConv<T>::value) ReadNumbers<T>(file, [&tmp](T value) { tmp.Push(value); });
+        else {
+            T value;
+            while (file >> value) tmp.Push(std::move(value));
+        }
+        if ((std::uint64_t)tmp.top == count && capacity > (std::uint64_t)tmp.len)
+            tmp.Resize((int)std::min<std::uint64_t>(capacity, INT_MAX));
+        tmp.growth = growth;
+        *this = std::move(tmp);
+    }
+    else throw std::runtime_error("text file requires operator>> for T");
+}
+
+template<class T, class Alloc>
+TSaveHandle TStack<T, Alloc>::SaveAsync(const std::string& filename, TSaveMode mode) const {
+    static_assert(std::is_trivially_copyable<T>::value, "SaveAsync requires trivially copyable T");
+    return SaveSnapshotAsync(filename, data, sizeof(T), top, len, mode);
+}
+
+// Результат свертки по всем подстекам: values[i] - агрегат i-го подстека
+// (определен, только если empty[i] == 0), total - агрегат всех элементов по порядку
+template <class T>
+struct TStackAggregates
+{
+    std::vector<T> values;
+    std::vector<char> empty;
+    T total;
+    bool hasTotal;
+};
+
+template <class T, class Alloc = std::allocator<T>>
+class TMultiStack
+{
+protected:
+    T* data;
+    int len;
+    int count;
+    int* begins;
+    int* tops;
+    int* oldTops;
+    int used;
+    int highWater;
+    TGrowthPolicy growth;
+    Alloc alloc;
+
+    void CheckIndex(int i) const;
+    void MoveRange(int from, int to, int n);
+    bool Repack(int i);
+    void Grow(int i);
+    void Clear();
+
+    // Меньше этого числа элементов свертка идет в вызывающем потоке
+    static constexpr int ParallelMinCount = 1 << 16;
+    std::vector<int> SplitStacks(int parts) const;
+    template <class F>
+    void ForEachStack(F f, int threadCount) const;
+public:
+    TMultiStack();
+    explicit TMultiStack(const Alloc& alloc_);
+    TMultiStack(int count_, int len_, const Alloc& alloc_ = Alloc());
+    TMultiStack(const TMultiStack& obj);
+    TMultiStack(TMultiStack&& obj);
+    ~TMultiStack();
+
+    Alloc GetAllocator() const;
+
+    int GetLen();
+    int GetStackCount();
+    int GetCount(int i);
+    int GetFreeCount();
+
+    void SetGrowthPolicy(const TGrowthPolicy& growth_);
+    const TGrowthPolicy& GetGrowthPolicy() const;
+    int GetHighWater();
+    void ResetHighWater();
+
+    void Push(int i, T value);
+    T Pop(int i);
+    T& Top(int i);
+
+    bool IsEmpty(int i);
+    bool IsFull();
+
+    TMultiStack& operator=(const TMultiStack<T, Alloc>& obj);
+    TMultiStack& operator=(TMultiStack<T, Alloc>&& obj);
+    bool operator==(const TMultiStack<T, Alloc>& obj);
+    bool operator!=(const TMultiStack<T, Alloc>& obj);
+
+    template <class O, class A>
+    friend std::ostream& operator<<(std::ostream& o, TMultiStack<O, A>& v);
+
+    T FindMin(int i) const;
+    TStackAggregates<T> FindMinAll(int threadCount = 0) const;
+    template <class Op>
+    TStackAggregates<T> AggregateAll(Op op, int threadCount = 0) const;
+
+    // Манифест filename и shardCount файлов-шардов filename.<k> (0 - по числу ядер),
+    // которые пишутся и читаются параллельно, по потоку на шард (TShardManifest)
+    void SaveToFile(const std::string& filename, int shardCount = 0) const;
+    void LoadFromFile(const std::string& filename);
+};
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::TMultiStack() : TMultiStack(Alloc()) {}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::TMultiStack(const Alloc& alloc_)
+    : data(nullptr), len(0), count(0), begins(nullptr), tops(nullptr), oldTops(nullptr), used(0), highWater(0), alloc(alloc_) {}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::TMultiStack(int count_, int len_, const Alloc& alloc_) : TMultiStack(alloc_) {
+    if (count_ <= 0) throw std::invalid_argument("count <= 0");
+    if (len_ < 0) throw std::invalid_argument("len < 0");
+    begins = new int[count_ + 1];
+    tops = new int[count_];
+    oldTops = new int[count_];
+    count = count_;
+    len = len_;
+    if (len > 0) data = std::allocator_traits<Alloc>::allocate(alloc, len);
+    // Свободное место изначально делится поровну
+    for (int i = 0; i < count; i++) begins[i] = tops[i] = oldTops[i] = (int)((long long)len * i / count);
+    begins[count] = len;
+}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::TMultiStack(const TMultiStack& obj)
+    : TMultiStack(std::allocator_traits<Alloc>::select_on_container_copy_construction(obj.alloc)) {
+    if (obj.count == 0) return;
+    begins = new int[obj.count + 1];
+    tops = new int[obj.count];
+    oldTops = new int[obj.count];
+    count = obj.count;
+    len = obj.len;
+    for (int i = 0; i < count; i++) begins[i] = tops[i] = obj.begins[i], oldTops[i] = obj.oldTops[i];
+    begins[count] = len;
+    if (len > 0) data = std::allocator_traits<Alloc>::allocate(alloc, len);
+    for (int i = 0; i < count; i++)
+        for (; tops[i] < obj.tops[i]; tops[i]++, used++) new (data + tops[i]) T(obj.data[tops[i]]);
+    highWater = obj.highWater;
+    growth = obj.growth;
+}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::TMultiStack(TMultiStack&& obj) : growth(obj.growth), alloc(obj.alloc) {
+    data = obj.data; len = obj.len; count = obj.count; begins = obj.begins; tops = obj.tops; oldTops = obj.oldTops;
+    used = obj.used; highWater = obj.highWater;
+
+    obj.data = nullptr; obj.len = obj.count = obj.used = obj.highWater = 0; obj.begins = obj.tops = obj.oldTops = nullptr;
+}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>::~TMultiStack() { Clear(); }
+
+template<class T, class Alloc>
+inline Alloc TMultiStack<T, Alloc>::GetAllocator() const { return alloc; }
+
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::Clear() {
+    for (int i = 0; i < count; i++)
+        for (int j = begins[i]; j < tops[i]; j++) data[j].~T();
+    if (data) std::allocator_traits<Alloc>::deallocate(alloc, data, len);
+    delete[] begins;
+    delete[] tops;
+    delete[] oldTops;
+    data = nullptr; len = count = used = 0; begins = tops = oldTops = nullptr;
+}
+
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::CheckIndex(int i) const {
+    if (i < 0 || i >= count) throw std::out_of_range("stack index out of range");
+}
+
+template<class T, class Alloc>
+inline int TMultiStack<T, Alloc>::GetLen() { return len; }
+
+template<class T, class Alloc>
+inline int TMultiStack<T, Alloc>::GetStackCount() { return count; }
+
+template<class T, class Alloc>
+inline int TMultiStack<T, Alloc>::GetCount(int i) {
+    CheckIndex(i);
+    return tops[i] - begins[i];
+}
+
+template<class T, class Alloc>
+inline int TMultiStack<T, Alloc>::GetFreeCount() { return len - used; }
+
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::SetGrowthPolicy(const TGrowthPolicy& growth_) { growth = growth_; }
+
+template<class T, class Alloc>
+inline const TGrowthPolicy& TMultiStack<T, Alloc>::GetGrowthPolicy() const { return growth; }
+
+template<class T, class Alloc>
+inline int TMultiStack<T, Alloc>::GetHighWater() { return highWater; }
+
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::ResetHighWater() { highWater = used; }
+
+template<class T, class Alloc>
+inline bool TMultiStack<T, Alloc>::IsEmpty(int i) {
+    CheckIndex(i);
+    return tops[i] == begins[i];
+}
+
+template<class T, class Alloc>
+inline bool TMultiStack<T, Alloc>::IsFull() { return GetFreeCount() == 0; }
+
+// Перенос n элементов с позиции from на позицию to, области могут пересекаться
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::MoveRange(int from, int to, int n) {
+    if (from == to || n == 0) return;
+    if (to < from) {
+        for (int j = 0; j < n; j++) {
+            new (data + to + j) T(std::move(data[from + j]));
+            data[from + j].~T();
+        }
+    }
+    else {
+        for (int j = n - 1; j >= 0; j--) {
+            new (data + to + j) T(std::move(data[from + j]));
+            data[from + j].~T();
+        }
+    }
+}
+
+// Перераспределение свободного места (Garwick, Knuth TAOCP 2.2.2, алгоритмы G и R):
+// 10% свободных ячеек делится поровну, 90% - пропорционально росту стеков с прошлой перепаковки
+template<class T, class Alloc>
+inline bool TMultiStack<T, Alloc>::Repack(int i) {
+    std::vector<int> sizes(count), growth(count), newBegins(count + 1);
+    long long freeCount = len, inc = 0;
+    for (int j = 0; j < count; j++) {
+        sizes[j] = tops[j] - begins[j] + (j == i);
+        growth[j] = std::max(0, tops[j] + (j == i) - oldTops[j]);
+        freeCount -= sizes[j];
+        inc += growth[j];
+    }
+    if (freeCount < 0) return false;
+
+    double alpha = 0.1 * freeCount / count;
+    double beta = inc > 0 ? 0.9 * freeCount / inc : 0.0;
+    double sigma = 0.0, tau;
+    newBegins[0] = begins[0];
+    newBegins[count] = len;
+    for (int j = 1; j < count; j++) {
+        tau = sigma + alpha + growth[j - 1] * beta;
+        newBegins[j] = newBegins[j - 1] + sizes[j - 1] + (int)tau - (int)sigma;
+        sigma = tau;
+    }
+
+    for (int j = 1; j < count; j++) {
+        if (newBegins[j] < begins[j]) {
+            MoveRange(begins[j], newBegins[j], tops[j] - begins[j]);
+            tops[j] -= begins[j] - newBegins[j];
+            begins[j] = newBegins[j];
+        }
+    }
+    for (int j = count - 1; j > 0; j--) {
+        if (newBegins[j] > begins[j]) {
+            MoveRange(begins[j], newBegins[j], tops[j] - begins[j]);
+            tops[j] += newBegins[j] - begins[j];
+            begins[j] = newBegins[j];
+        }
+    }
+    for (int j = 0; j < count; j++) oldTops[j] = tops[j] + (j == i);
+    return true;
+}
+
+// Весь буфер заполнен: переезд в буфер большего размера и перепаковка
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::Grow(int i) {
+    int newLen = growth.NextLen(len, used + 1);
+    if (newLen < 0) throw std::logic_error("stack is full");
+    T* newData = std::allocator_traits<Alloc>::allocate(alloc, newLen);
+    for (int j = 0; j < count; j++) {
+        for (int k = begins[j]; k < tops[j]; k++) {
+            new (newData + k) T(std::move(data[k]));
+            data[k].~T();
+        }
+    }
+    if (data) std::allocator_traits<Alloc>::deallocate(alloc, data, len);
+    data = newData;
+    len = newLen;
+    begins[count] = len;
+    Repack(i);
+}
+
+template<class T, class Alloc>
+inline void TMultiStack<T, Alloc>::Push(int i, T value) {
+    CheckIndex(i);
+    if (tops[i] == begins[i + 1] && !Repack(i)) Grow(i);
+    new (data + tops[i]) T(std::move(value));
+    tops[i]++;
+    if (++used > highWater) highWater = used;
+}
+
+template<class T, class Alloc>
+inline T TMultiStack<T, Alloc>::Pop(int i) {
+    CheckIndex(i);
+    if (tops[i] == begins[i]) throw std::logic_error("stack is empty");
+    tops[i]--;
+    used--;
+    T val = std::move(data[tops[i]]);
+    data[tops[i]].~T();
+    return val;
+}
+
+template<class T, class Alloc>
+inline T& TMultiStack<T, Alloc>::Top(int i) {
+    CheckIndex(i);
+    if (tops[i] == begins[i]) throw std::logic_error("stack is empty");
+    return data[tops[i] - 1];
+}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>& TMultiStack<T, Alloc>::operator=(const TMultiStack<T, Alloc>& obj) {
+    if (this == &obj) return *this;
+    TMultiStack<T, Alloc> tmp(obj);
+    return *this = std::move(tmp);
+}
+
+template<class T, class Alloc>
+inline TMultiStack<T, Alloc>& TMultiStack<T, Alloc>::operator=(TMultiStack<T, Alloc>&& obj) {
+    if (this == &obj) return *this;
+
+    Clear();
+
+    data = obj.data; len = obj.len; count = obj.count; begins = obj.begins; tops = obj.tops; oldTops = obj.oldTops;
+    used = obj.used; highWater = obj.highWater; growth = obj.growth; alloc = obj.alloc;
+
+    obj.data = nullptr; obj.len = obj.count = obj.used = obj.highWater = 0; obj.begins = obj.tops = obj.oldTops = nullptr;
+
+    return *this;
+}
+
+template<class T, class Alloc>
+inline bool TMultiStack<T, Alloc>::operator==(const TMultiStack<T, Alloc>& obj) {
+    if (count != obj.count) return false;
+    for (int i = 0; i < count; i++) {
+        int n = tops[i] - begins[i];
+        if (n != obj.tops[i] - obj.begins[i]) return false;
+        for (int j = 0; j < n; j++)
+            if (data[begins[i] + j] != obj.data[obj.begins[i] + j]) return false;
+    }
+    return true;
+}
+
+template<class T, class Alloc>
+inline bool TMultiStack<T, Alloc>::operator!=(const TMultiStack<T, Alloc>& obj) { return !(*this == obj); }
+
+template<class O, class A>
+inline std::ostream& operator<<(std::ostream& o, TMultiStack<O, A>& v) {
+    o << "TMultiStack[len=" << v.len << ", count=" << v.count << "]\n";
+    for (int i = 0; i < v.count; i++) {
+        o << "Stack " << i << ": ";
+        bool done = false;
+        if constexpr (THasCharsConv<O>::value) done = WriteNumbers(o, v.data + v.begins[i], v.tops[i] - v.begins[i], ", ");
+        if (!done)
+            for (int j = v.begins[i]; j < v.tops[i]; j++) o << v.data[j] << (j < v.tops[i] - 1 ? ", " : "");
+        o << "\n";
     }
+    return o;
+}
+
+template<class T, class Alloc>
+T TMultiStack<T, Alloc>::FindMin(int i) const {
+    CheckIndex(i);
+    if (tops[i] == begins[i]) throw std::logic_error("Cannot find min in empty stack");
+    if constexpr (THasSimdMin<T>::value) return SimdMin(data + begins[i], tops[i] - begins[i]);
+    T minValue = data[begins[i]];
+    for (int j = begins[i] + 1; j < tops[i]; j++)
+        if (data[j] < minValue) minValue = data[j];
+    return minValue;
+}
 
-    std::vector<T> temp;
-    T value;
-    while (file >> value) temp.push_back(value);
+// Границы не более чем parts непрерывных диапазонов подстеков примерно с равным
+// числом элементов: диапазон k - подстеки [bounds[k], bounds[k + 1])
+template<class T, class Alloc>
+std::vector<int> TMultiStack<T, Alloc>::SplitStacks(int parts) const {
+    parts = std::max(1, std::min(parts, count));
+    std::vector<int> bounds(1, 0);
+    long long acc = 0;
+    for (int i = 0; i + 1 < count && (int)bounds.size() < parts; i++) {
+        acc += tops[i] - begins[i];
+        if (acc * parts >= (long long)used * (long long)bounds.size()) bounds.push_back(i + 1);
+    }
+    bounds.push_back(count);
+    return bounds;
+}
 
-    if (!temp.empty()) {
-        len = temp.size();
-        data = new T * [len];
-        top = len;
-        isNew = true;
-        for (int i = 0; i < top; i++) data[i] = new T(temp[i]);
+// Подстеки делятся на threadCount (0 - по числу ядер) диапазонов SplitStacks;
+// первый диапазон обрабатывает вызывающий поток
+template<class T, class Alloc>
+template<class F>
+void TMultiStack<T, Alloc>::ForEachStack(F f, int threadCount) const {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (used < ParallelMinCount) threadCount = 1;
+    threadCount = std::max(1, std::min(threadCount, count));
+    if (threadCount == 1) {
+        for (int i = 0; i < count; i++) f(i);
+        return;
     }
+    std::vector<int> bounds = SplitStacks(threadCount);
+
+    int parts = (int)bounds.size() - 1;
+    std::vector<std::exception_ptr> errors(parts);
+    auto run = [&](int k) {
+        try { for (int i = bounds[k]; i < bounds[k + 1]; i++) f(i); }
+        catch (...) { errors[k] = std::current_exception(); }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(parts - 1);
+    for (int k = 1; k < parts; k++) threads.emplace_back(run, k);
+    run(0);
+    for (auto& t : threads) t.join();
+    for (auto& e : errors)
+        if (e) std::rethrow_exception(e);
+}
+
+template<class T, class Alloc>
+template<class Op>
+TStackAggregates<T> TMultiStack<T, Alloc>::AggregateAll(Op op, int threadCount) const {
+    TStackAggregates<T> res{ std::vector<T>(count), std::vector<char>(count, 1), T(), false };
+    ForEachStack([&](int i) {
+        if (tops[i] == begins[i]) return;
+        T acc = data[begins[i]];
+        for (int j = begins[i] + 1; j < tops[i]; j++) acc = op(acc, data[j]);
+        res.values[i] = std::move(acc);
+        res.empty[i] = 0;
+    }, threadCount);
+    for (int i = 0; i < count; i++) {
+        if (res.empty[i]) continue;
+        res.total = res.hasTotal ? op(res.total, res.values[i]) : res.values[i];
+        res.hasTotal = true;
+    }
+    return res;
+}
+
+template<class T, class Alloc>
+TStackAggregates<T> TMultiStack<T, Alloc>::FindMinAll(int threadCount) const {
+    auto minOp = [](const T& a, const T& b) { return b < a ? b : a; };
+    if constexpr (!THasSimdMin<T>::value) return AggregateAll(minOp, threadCount);
     else {
-        data = nullptr;
-        len = top = 0;
-        isNew = true;
+        TStackAggregates<T> res{ std::vector<T>(count), std::vector<char>(count, 1), T(), false };
+        ForEachStack([&](int i) {
+            if (tops[i] == begins[i]) return;
+            res.values[i] = SimdMin(data + begins[i], tops[i] - begins[i]);
+            res.empty[i] = 0;
+        }, threadCount);
+        for (int i = 0; i < count; i++) {
+            if (res.empty[i]) continue;
+            res.total = res.hasTotal ? minOp(res.total, res.values[i]) : res.values[i];
+            res.hasTotal = true;
+        }
+        return res;
+    }
+}
+
+template<class T, class Alloc>
+void TMultiStack<T, Alloc>::SaveToFile(const std::string& filename, int shardCount) const {
+    static_assert(std::is_trivially_copyable<T>::value, "sharded snapshots require trivially copyable T");
+    if (count == 0) throw std::logic_error("multistack is empty");
+    if (shardCount <= 0) shardCount = (int)std::thread::hardware_concurrency();
+    TShardManifest m;
+    m.elemSize = sizeof(T);
+    m.len = len;
+    m.begins.assign(begins, begins + count);
+    m.tops.assign(tops, tops + count);
+    m.firstStacks = SplitStacks(shardCount);
+    int shards = (int)m.firstStacks.size() - 1;
+    std::string base = filename.substr(filename.rfind('/') + 1);
+    for (int k = 0; k < shards; k++) m.files.push_back(base + "." + std::to_string(k));
+
+    ParallelFor(shards, [&](int k) {
+        std::uint64_t n = 0, h = SnapshotChecksumSeed;
+        for (int i = m.firstStacks[k]; i < m.firstStacks[k + 1]; i++) {
+            n += tops[i] - begins[i];
+            h = SnapshotChecksum(data + begins[i], (std::size_t)(tops[i] - begins[i]) * sizeof(T), h);
+        }
+        TSnapshotHeader header = MakeSnapshotHeader(sizeof(T), 0, 0, nullptr);
+        header.count = header.capacity = n;
+        header.checksum = h;
+        std::string path = SiblingPath(filename, m.files[k]);
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Cannot open file: " + path);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int i = m.firstStacks[k]; i < m.firstStacks[k + 1]; i++)
+            file.write(reinterpret_cast<const char*>(data + begins[i]), (std::streamsize)(tops[i] - begins[i]) * sizeof(T));
+        if (!file) throw std::runtime_error("Cannot write file: " + path);
+    }, shards);
+    WriteShardManifest(filename, m);
+}
+
+template<class T, class Alloc>
+void TMultiStack<T, Alloc>::LoadFromFile(const std::string& filename) {
+    static_assert(std::is_trivially_copyable<T>::value, "sharded snapshots require trivially copyable T");
+    TShardManifest m = ReadShardManifest(filename);
+    if (m.elemSize != sizeof(T)) throw std::runtime_error("Snapshot element size mismatch: " + filename);
+    int stacks = (int)m.begins.size(), shards = (int)m.files.size();
+
+    TMultiStack<T, Alloc> tmp(stacks, m.len, alloc);
+    tmp.growth = growth;
+    for (int i = 0; i < stacks; i++) tmp.begins[i] = tmp.tops[i] = tmp.oldTops[i] = m.begins[i];
+    ParallelFor(shards, [&](int k) {
+        std::string path = SiblingPath(filename, m.files[k]);
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Cannot open file: " + path);
+        TSnapshotHeader header;
+        if (!ReadSnapshotHeader(file, header)) throw std::runtime_error("Not a snapshot: " + path);
+        CheckSnapshotHeader(header, sizeof(T), INT_MAX);
+        std::uint64_t n = 0, h = SnapshotChecksumSeed;
+        for (int i = m.firstStacks[k]; i < m.firstStacks[k + 1]; i++) n += m.tops[i] - m.begins[i];
+        if (header.flags != 0 || header.count != n) throw std::runtime_error("Shard does not match manifest: " + path);
+        for (int i = m.firstStacks[k]; i < m.firstStacks[k + 1]; i++) {
+            int c = m.tops[i] - m.begins[i];
+            file.read(reinterpret_cast<char*>(tmp.data + m.begins[i]), (std::streamsize)c * sizeof(T));
+            if (!file) throw std::runtime_error("Snapshot is truncated: " + path);
+            h = SnapshotChecksum(tmp.data + m.begins[i], (std::size_t)c * sizeof(T), h);
+        }
+        if (h != header.checksum) throw std::runtime_error("Snapshot checksum mismatch: " + path);
+    }, shards);
+    for (int i = 0; i < stacks; i++) {
+        tmp.tops[i] = tmp.oldTops[i] = m.tops[i];
+        tmp.used += m.tops[i] - m.begins[i];
     }
+    tmp.highWater = tmp.used;
+    *this = std::move(tmp);
 }
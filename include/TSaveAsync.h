@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Fork - снимок пишет дочерний процесс: ядро разделяет страницы родителя копированием
+// при записи, поэтому родитель не ждет ни записи, ни копирования буфера.
+// Thread - буфер копируется (memcpy) и пишется фоновым потоком.
+// Auto - Fork там, где он есть, иначе или при ошибке fork() - Thread.
+enum class TSaveMode { Auto, Fork, Thread };
+
+// Результат асинхронного сохранения. Последняя копия дескриптора в деструкторе
+// дожидается окончания записи (ошибки при этом не выбрасываются).
+class TSaveHandle
+{
+public:
+    struct TState;
+
+    TSaveHandle() {}
+    explicit TSaveHandle(std::shared_ptr<TState> state_) : state(std::move(state_)) {}
+
+    bool IsDone();
+    // Ждет окончания записи; бросает std::runtime_error, если снимок не записан
+    void Wait();
+    TSaveMode GetMode() const;
+protected:
+    std::shared_ptr<TState> state;
+};
+
+// Пишет двоичный снимок count элементов по elemSize байт (формат TSnapshot.h) в filename
+// через filename.tmp + fsync + rename, не блокируя вызывающий поток на время записи
+TSaveHandle SaveSnapshotAsync(const std::string& filename, const void* data, std::uint32_t elemSize,
+                              std::uint64_t count, std::uint64_t capacity, TSaveMode mode);
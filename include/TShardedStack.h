@@ -0,0 +1,162 @@
+#pragma once
+
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "TMultiStack.h"
+
+// Пул задач LIFO поверх TMultiStack: у каждого рабочего потока свой подстек (шард) со своей
+// блокировкой, которую, кроме владельца, берет только вор. Если у подстека кончилось место,
+// поток захватывает блокировки всех шардов и выполняет обычный TMultiStack::Push
+// с перепаковкой. Если свой подстек пуст, поток крадет пачку элементов с вершины чужого.
+template <class T>
+class TShardedStack : protected TMultiStack<T>
+{
+protected:
+    struct alignas(64) TShard
+    {
+        std::mutex m;
+    };
+    TShard* shards;
+    int stealBatch;
+
+    void CheckShard(int shard) const;
+    void LockAll();
+    void UnlockAll();
+    bool PopLocal(int shard, T& value);
+    bool Steal(int shard, T& value);
+public:
+    TShardedStack(int shardCount, int len_, int stealBatch_ = 32, const TGrowthPolicy& growth = TGrowthPolicy::Geometric());
+    TShardedStack(const TShardedStack&) = delete;
+    TShardedStack& operator=(const TShardedStack&) = delete;
+    ~TShardedStack();
+
+    int GetShardCount();
+    int GetCount();
+    int GetCount(int shard);
+
+    void Push(int shard, T value);
+    T Pop(int shard);
+    bool TryPop(int shard, T& value);
+
+    bool IsEmpty();
+};
+
+template<class T>
+inline TShardedStack<T>::TShardedStack(int shardCount, int len_, int stealBatch_, const TGrowthPolicy& growth)
+    : TMultiStack<T>(shardCount, len_), shards(nullptr), stealBatch(stealBatch_) {
+    if (stealBatch_ <= 0) throw std::invalid_argument("stealBatch <= 0");
+    this->SetGrowthPolicy(growth);
+    shards = new TShard[shardCount];
+}
+
+template<class T>
+inline TShardedStack<T>::~TShardedStack() { delete[] shards; }
+
+template<class T>
+inline void TShardedStack<T>::CheckShard(int shard) const { this->CheckIndex(shard); }
+
+template<class T>
+inline void TShardedStack<T>::LockAll() {
+    for (int i = 0; i < this->count; i++) shards[i].m.lock();
+}
+
+template<class T>
+inline void TShardedStack<T>::UnlockAll() {
+    for (int i = this->count - 1; i >= 0; i--) shards[i].m.unlock();
+}
+
+template<class T>
+inline int TShardedStack<T>::GetShardCount() { return this->count; }
+
+template<class T>
+inline int TShardedStack<T>::GetCount(int shard) {
+    CheckShard(shard);
+    std::lock_guard<std::mutex> guard(shards[shard].m);
+    return this->tops[shard] - this->begins[shard];
+}
+
+template<class T>
+inline int TShardedStack<T>::GetCount() {
+    int res = 0;
+    for (int i = 0; i < this->count; i++) res += GetCount(i);
+    return res;
+}
+
+template<class T>
+inline bool TShardedStack<T>::IsEmpty() { return GetCount() == 0; }
+
+// Быстрый путь трогает только свой подстек; счетчик used базового класса
+// пересчитывается лишь под всеми блокировками перед перепаковкой
+template<class T>
+inline void TShardedStack<T>::Push(int shard, T value) {
+    CheckShard(shard);
+    {
+        std::lock_guard<std::mutex> guard(shards[shard].m);
+        int& top = this->tops[shard];
+        if (top < this->begins[shard + 1]) {
+            new (this->data + top) T(std::move(value));
+            top++;
+            return;
+        }
+    }
+    LockAll();
+    try {
+        this->used = 0;
+        for (int i = 0; i < this->count; i++) this->used += this->tops[i] - this->begins[i];
+        TMultiStack<T>::Push(shard, std::move(value));
+    }
+    catch (...) {
+        UnlockAll();
+        throw;
+    }
+    UnlockAll();
+}
+
+template<class T>
+inline bool TShardedStack<T>::PopLocal(int shard, T& value) {
+    std::lock_guard<std::mutex> guard(shards[shard].m);
+    int& top = this->tops[shard];
+    if (top == this->begins[shard]) return false;
+    top--;
+    value = std::move(this->data[top]);
+    this->data[top].~T();
+    return true;
+}
+
+// Кража: с вершины первого непустого чужого подстека берется до stealBatch элементов
+// (не больше половины); верхний отдается вызывающему, остальные кладутся в свой подстек
+template<class T>
+inline bool TShardedStack<T>::Steal(int shard, T& value) {
+    std::vector<T> batch;
+    for (int k = 1; k < this->count && batch.empty(); k++) {
+        int victim = (shard + k) % this->count;
+        std::lock_guard<std::mutex> guard(shards[victim].m);
+        int& top = this->tops[victim];
+        int n = std::min(stealBatch, (top - this->begins[victim] + 1) / 2);
+        for (int j = top - n; j < top; j++) {
+            batch.push_back(std::move(this->data[j]));
+            this->data[j].~T();
+        }
+        top -= n;
+    }
+    if (batch.empty()) return false;
+    value = std::move(batch.back());
+    batch.pop_back();
+    for (auto& item : batch) Push(shard, std::move(item));
+    return true;
+}
+
+template<class T>
+inline bool TShardedStack<T>::TryPop(int shard, T& value) {
+    CheckShard(shard);
+    return PopLocal(shard, value) || Steal(shard, value);
+}
+
+template<class T>
+inline T TShardedStack<T>::Pop(int shard) {
+    T value;
+    if (!TryPop(shard, value)) throw std::logic_error("stack is empty");
+    return value;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// Векторизованный поиск минимума для непрерывных массивов int32/int64/float/double.
+// Набор инструкций (AVX-512F, AVX2, SSE4.2 или скалярный цикл) выбирается при первом
+// вызове по возможностям процессора. count должен быть больше нуля.
+// Результат совпадает со скалярным циклом "if (a[i] < m) m = a[i]" с m = a[0]:
+// NaN пропускаются, если только NaN не стоит в a[0].
+std::int32_t SimdMin(const std::int32_t* data, int count);
+std::int64_t SimdMin(const std::int64_t* data, int count);
+float SimdMin(const float* data, int count);
+double SimdMin(const double* data, int count);
+
+// Имя выбранного набора инструкций: "avx512f", "avx2", "sse4.2" или "scalar"
+const char* SimdMinIsa();
+
+template <class T>
+struct THasSimdMin : std::integral_constant<bool,
+    std::is_same<T, std::int32_t>::value || std::is_same<T, std::int64_t>::value ||
+    std::is_same<T, float>::value || std::is_same<T, double>::value> {};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// DeltaVarint и FrameOfReference - сжатые по блокам двоичные снимки для целых T (TBlockCodec.h)
+enum class TFileFormat { Text, Binary, DeltaVarint, FrameOfReference };
+enum class TMapMode { ReadOnly, CopyOnWrite };
+
+// Двоичный снимок стека: 64-байтный заголовок и сразу за ним элементы подряд
+// (данные выровнены на 64 байта от начала файла). Порядок байт - как у машины, записавшей файл.
+const char SnapshotMagic[8] = { 'T', 'M', 'S', 'T', 'A', 'C', 'K', '\0' };
+// Версия 1 - несжатые данные, версия 2 - сжатые блоки (кодек в flags)
+const std::uint32_t SnapshotVersion = 2;
+
+struct TSnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t elemSize;
+    std::uint32_t flags;
+    std::uint64_t count;
+    std::uint64_t capacity;
+    std::uint64_t checksum;
+    std::uint64_t generation;
+    std::uint8_t reserved[8];
+};
+static_assert(sizeof(TSnapshotHeader) == 64, "snapshot header must be 64 bytes");
+
+// FNV-1a (64 бита) по 8-байтным словам, хвост - по байтам. Сумму нескольких
+// участков считают цепочкой, передавая результат предыдущего как seed
+const std::uint64_t SnapshotChecksumSeed = 14695981039346656037ULL;
+std::uint64_t SnapshotChecksum(const void* data, std::size_t bytes, std::uint64_t seed = SnapshotChecksumSeed);
+
+TSnapshotHeader MakeSnapshotHeader(std::uint32_t elemSize, std::uint64_t count, std::uint64_t capacity, const void* data);
+
+// Записывает заголовок и данные через write(). При durable файл пишется во временный
+// filename.tmp, сбрасывается на диск (fsync) и атомарно переименовывается
+void WriteSnapshotFile(const std::string& filename, const TSnapshotHeader& header, const void* data, bool durable);
+// fsync каталога, в котором лежит filename (закрепляет rename)
+void SyncDirectory(const std::string& filename);
+
+// Читает заголовок, если поток начинается с сигнатуры снимка; иначе возвращает false
+// и восстанавливает позицию потока
+bool ReadSnapshotHeader(std::istream& in, TSnapshotHeader& header);
+
+// Проверяет версию (1..SnapshotVersion), размер элемента и count <= capacity <= maxCount; бросает std::runtime_error
+void CheckSnapshotHeader(const TSnapshotHeader& header, std::uint32_t elemSize, std::uint64_t maxCount);
+
+// Сверяет контрольную сумму данных с заголовком; бросает std::runtime_error
+void CheckSnapshotData(const TSnapshotHeader& header, const void* data);
+
+// Необязательная первая строка текстового файла: "#TStack count=<n> capacity=<len>".
+// Загрузчик берет из нее емкость, чтобы не перевыделять буфер по ходу чтения
+void WriteTextHeader(std::ostream& out, std::uint64_t count, std::uint64_t capacity);
+// Читает строку заголовка, если поток начинается с нее; иначе возвращает false и не трогает поток
+bool ReadTextHeader(std::istream& in, std::uint64_t& count, std::uint64_t& capacity);
+
+// Манифест снимка TMultiStack, разбитого на файлы-шарды. Текст:
+//   #TMultiStack version=1 elemSize=<n> len=<len> stacks=<count> shards=<k>
+//   stack <i> begin=<b> top=<t>      - по строке на подстек
+//   shard <k> first=<i> file=<name>  - шард k хранит подстеки first..(first следующего - 1)
+// Шард - двоичный снимок, в котором элементы его подстеков лежат подряд, а контрольная
+// сумма считается цепочкой по подстекам. Имена файлов - относительно каталога манифеста
+struct TShardManifest
+{
+    std::uint32_t elemSize;
+    int len;
+    std::vector<int> begins;
+    std::vector<int> tops;
+    std::vector<int> firstStacks;
+    std::vector<std::string> files;
+};
+
+void WriteShardManifest(const std::string& filename, const TShardManifest& manifest);
+// Проверяет согласованность границ подстеков и шардов; бросает std::runtime_error
+TShardManifest ReadShardManifest(const std::string& filename);
+// Путь к файлу name в каталоге, где лежит filename
+std::string SiblingPath(const std::string& filename, const std::string& name);
+
+// Файл снимка, отображенный в память (mmap). ReadOnly - страницы только для чтения,
+// CopyOnWrite - закрытое отображение: запись копирует страницу и не попадает в файл.
+// Заголовок проверяется всегда, контрольная сумма - только при verify (она читает весь файл).
+class TSnapshotMapping
+{
+protected:
+    void* addr;
+    std::size_t size;
+    TSnapshotHeader header;
+    TMapMode mode;
+public:
+    TSnapshotMapping(const std::string& filename, TMapMode mode_, std::uint32_t elemSize, std::uint64_t maxCount, bool verify);
+    TSnapshotMapping(const TSnapshotMapping&) = delete;
+    TSnapshotMapping& operator=(const TSnapshotMapping&) = delete;
+    ~TSnapshotMapping();
+
+    const TSnapshotHeader& GetHeader() const { return header; }
+    TMapMode GetMode() const { return mode; }
+    void* GetData() const { return static_cast<char*>(addr) + sizeof(TSnapshotHeader); }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Бэкенд ввода-вывода двоичных снимков. Stream - std::ofstream/ifstream;
+// Pwrite - пул потоков с pwrite/pread по блокам chunkLen; IoUring - очередь io_uring
+// глубиной queueDepth (без liburing, через системные вызовы). Если io_uring недоступен,
+// используется Pwrite; если файловая система не поддерживает O_DIRECT - обычный режим.
+enum class TIoBackend { Stream, Pwrite, IoUring };
+
+struct TIoOptions
+{
+    TIoBackend backend;
+    bool direct;          // O_DIRECT: мимо страничного кэша, блоки и буферы выровнены на IoAlign
+    int queueDepth;       // запросов в полете (потоков для Pwrite)
+    std::size_t chunkLen; // байт в одном запросе, кратно IoAlign
+
+    TIoOptions() : backend(TIoBackend::Stream), direct(false), queueDepth(32), chunkLen(1 << 20) {}
+};
+
+const std::size_t IoAlign = 4096;
+
+// true, если io_uring создается и ядро поддерживает IORING_OP_WRITE/READ
+bool IsIoUringAvailable();
+
+// Пишет в файл подряд head (headBytes) и data (dataBytes) блоками по chunkLen; файл
+// создается заново. Возвращает бэкенд, которым запись реально выполнена
+TIoBackend WriteFileRange(const std::string& filename, const void* head, std::size_t headBytes,
+                          const void* data, std::size_t dataBytes, const TIoOptions& options);
+// Читает bytes байт файла с позиции offset в data
+TIoBackend ReadFileRange(const std::string& filename, std::size_t offset, void* data, std::size_t bytes,
+                         const TIoOptions& options);
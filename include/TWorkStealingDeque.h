@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+// Общая арена для кольцевых буферов нескольких деков: один непрерывный участок памяти,
+// который деки делят сдвигом атомарного указателя (как подстеки в TMultiStack).
+// Память возвращается только при разрушении арены, поэтому старые буферы после роста
+// остаются доступными ворам, которые еще могут их читать.
+class TDequeArena
+{
+protected:
+    char* data;
+    std::size_t len;
+    std::atomic<std::size_t> used;
+public:
+    TDequeArena(std::size_t len_) : data(nullptr), len(len_), used(0) {
+        if (len_ == 0) throw std::invalid_argument("len == 0");
+        data = static_cast<char*>(::operator new(len_));
+    }
+    TDequeArena(const TDequeArena&) = delete;
+    TDequeArena& operator=(const TDequeArena&) = delete;
+    ~TDequeArena() { ::operator delete(data); }
+
+    // nullptr, если места не осталось
+    void* Allocate(std::size_t size, std::size_t align) {
+        std::size_t cur = used.load(std::memory_order_relaxed);
+        for (;;) {
+            std::size_t start = (cur + align - 1) / align * align;
+            if (start + size > len) return nullptr;
+            if (used.compare_exchange_weak(cur, start + size, std::memory_order_relaxed)) return data + start;
+        }
+    }
+    std::size_t GetLen() const { return len; }
+    std::size_t GetUsed() const { return used.load(std::memory_order_relaxed); }
+};
+
+// Дек Chase-Lev (Chase, Lev, 2005; модель памяти C11 по Le, Pop, Cohen, Zappa Nardelli, 2013).
+// Владелец кладет и снимает элементы снизу без блокировок, воры забирают сверху через CAS.
+// Буфер кольцевой и растет удвоением; старые буферы освобождаются только в деструкторе.
+template <class T>
+class TWorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable<T>::value, "TWorkStealingDeque requires trivially copyable T");
+protected:
+    struct TRing
+    {
+        long long mask;
+        std::atomic<T>* cells;
+        bool isNew;
+        TRing* prev;
+
+        T Get(long long i) const { return cells[i & mask].load(std::memory_order_relaxed); }
+        void Put(long long i, T value) { cells[i & mask].store(value, std::memory_order_relaxed); }
+    };
+    alignas(64) std::atomic<long long> top;
+    alignas(64) std::atomic<long long> bottom;
+    std::atomic<TRing*> ring;
+    TDequeArena* arena;
+
+    TRing* NewRing(long long len_, TRing* prev);
+    TRing* Grow(TRing* old, long long b, long long t);
+public:
+    TWorkStealingDeque(int len_ = 64, TDequeArena* arena_ = nullptr);
+    TWorkStealingDeque(const TWorkStealingDeque&) = delete;
+    TWorkStealingDeque& operator=(const TWorkStealingDeque&) = delete;
+    ~TWorkStealingDeque();
+
+    int GetLen();
+    int GetCount();
+
+    void Push(T value);
+    T Pop();
+    bool TryPop(T& value);
+    bool Steal(T& value);
+
+    bool IsEmpty();
+};
+
+template<class T>
+inline TWorkStealingDeque<T>::TWorkStealingDeque(int len_, TDequeArena* arena_) : top(0), bottom(0), ring(nullptr), arena(arena_) {
+    if (len_ <= 0) throw std::invalid_argument("len <= 0");
+    long long len = 1;
+    while (len < len_) len <<= 1;
+    ring.store(NewRing(len, nullptr), std::memory_order_relaxed);
+}
+
+template<class T>
+inline TWorkStealingDeque<T>::~TWorkStealingDeque() {
+    TRing* r = ring.load(std::memory_order_relaxed);
+    while (r) {
+        TRing* prev = r->prev;
+        if (r->isNew) ::operator delete(r->cells);
+        delete r;
+        r = prev;
+    }
+}
+
+// Ячейки берутся из общей арены, а когда она заполнена - из кучи
+template<class T>
+inline typename TWorkStealingDeque<T>::TRing* TWorkStealingDeque<T>::NewRing(long long len_, TRing* prev) {
+    std::size_t bytes = sizeof(std::atomic<T>) * (std::size_t)len_;
+    void* mem = arena ? arena->Allocate(bytes, alignof(std::atomic<T>)) : nullptr;
+    bool isNew = mem == nullptr;
+    if (isNew) mem = ::operator new(bytes);
+    TRing* r = new TRing{ len_ - 1, static_cast<std::atomic<T>*>(mem), isNew, prev };
+    for (long long i = 0; i < len_; i++) new (r->cells + i) std::atomic<T>();
+    return r;
+}
+
+template<class T>
+inline typename TWorkStealingDeque<T>::TRing* TWorkStealingDeque<T>::Grow(TRing* old, long long b, long long t) {
+    TRing* r = NewRing((old->mask + 1) * 2, old);
+    for (long long i = t; i < b; i++) r->Put(i, old->Get(i));
+    ring.store(r, std::memory_order_release);
+    return r;
+}
+
+template<class T>
+inline int TWorkStealingDeque<T>::GetLen() { return (int)(ring.load(std::memory_order_relaxed)->mask + 1); }
+
+template<class T>
+inline int TWorkStealingDeque<T>::GetCount() {
+    long long b = bottom.load(std::memory_order_relaxed);
+    long long t = top.load(std::memory_order_relaxed);
+    return b > t ? (int)(b - t) : 0;
+}
+
+template<class T>
+inline bool TWorkStealingDeque<T>::IsEmpty() { return GetCount() == 0; }
+
+template<class T>
+inline void TWorkStealingDeque<T>::Push(T value) {
+    long long b = bottom.load(std::memory_order_relaxed);
+    long long t = top.load(std::memory_order_acquire);
+    TRing* r = ring.load(std::memory_order_relaxed);
+    if (b - t > r->mask) r = Grow(r, b, t);
+    r->Put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+template<class T>
+inline bool TWorkStealingDeque<T>::TryPop(T& value) {
+    long long b = bottom.load(std::memory_order_relaxed) - 1;
+    TRing* r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    value = r->Get(b);
+    if (t < b) return true;
+    // Последний элемент: владелец соревнуется с ворами за top
+    bool ok = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return ok;
+}
+
+template<class T>
+inline T TWorkStealingDeque<T>::Pop() {
+    T value;
+    if (!TryPop(value)) throw std::logic_error("deque is empty");
+    return value;
+}
+
+template<class T>
+inline bool TWorkStealingDeque<T>::Steal(T& value) {
+    long long t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    TRing* r = ring.load(std::memory_order_acquire);
+    T item = r->Get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+    value = item;
+    return true;
+}
@@ -0,0 +1,71 @@
+#include "TAllocator.h"
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+const std::size_t arenaAlign = alignof(std::max_align_t);
+
+std::size_t RoundUp(std::size_t size, std::size_t align) { return (size + align - 1) / align * align; }
+}
+
+TArena::TArena(std::size_t blockSize_) : block(nullptr), cur(nullptr), end(nullptr), blockSize(blockSize_), used(0) {
+    if (blockSize_ == 0) throw std::invalid_argument("blockSize == 0");
+}
+
+TArena::~TArena() {
+    while (block) {
+        TBlock* prev = block->prev;
+        ::operator delete(block);
+        block = prev;
+    }
+}
+
+void TArena::AddBlock(std::size_t minSize) {
+    std::size_t header = RoundUp(sizeof(TBlock), arenaAlign);
+    std::size_t size = std::max(blockSize, minSize);
+    TBlock* b = static_cast<TBlock*>(::operator new(header + size));
+    b->prev = block;
+    b->size = size;
+    block = b;
+    cur = reinterpret_cast<char*>(b) + header;
+    end = cur + size;
+}
+
+void* TArena::Allocate(std::size_t size, std::size_t align) {
+    size = RoundUp(size, arenaAlign);
+    std::uintptr_t p = RoundUp(reinterpret_cast<std::uintptr_t>(cur), align);
+    if (!cur || p + size > reinterpret_cast<std::uintptr_t>(end)) {
+        AddBlock(size + (align > arenaAlign ? align : 0));
+        p = RoundUp(reinterpret_cast<std::uintptr_t>(cur), align);
+    }
+    cur = reinterpret_cast<char*>(p + size);
+    used += size;
+    return reinterpret_cast<void*>(p);
+}
+
+void TArena::Deallocate(void* p, std::size_t size) {
+    size = RoundUp(size, arenaAlign);
+    if (static_cast<char*>(p) + size != cur) return;
+    cur = static_cast<char*>(p);
+    used -= size;
+}
+
+void TArena::Reset() {
+    if (!block) return;
+    while (block->prev) {
+        TBlock* prev = block->prev->prev;
+        ::operator delete(block->prev);
+        block->prev = prev;
+    }
+    cur = reinterpret_cast<char*>(block) + RoundUp(sizeof(TBlock), arenaAlign);
+    end = cur + block->size;
+    used = 0;
+}
+
+std::size_t TArena::GetUsed() const { return used; }
+
+int TArena::GetBlockCount() const {
+    int res = 0;
+    for (TBlock* b = block; b; b = b->prev) res++;
+    return res;
+}
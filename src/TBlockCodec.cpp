@@ -0,0 +1,31 @@
+#include "TBlockCodec.h"
+#include <atomic>
+#include <exception>
+#include <thread>
+
+// Потоки разбирают индексы по одному через общий счетчик, вызывающий поток работает наравне с ними
+void ParallelFor(int n, const std::function<void(int)>& f, int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    threadCount = std::min(threadCount, n);
+    if (threadCount <= 1) {
+        for (int i = 0; i < n; i++) f(i);
+        return;
+    }
+    std::atomic<int> next(0);
+    std::vector<std::exception_ptr> errors(threadCount);
+    auto run = [&](int k) {
+        try {
+            for (int i = next++; i < n; i = next++) f(i);
+        }
+        catch (...) {
+            errors[k] = std::current_exception();
+            next = n;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int k = 1; k < threadCount; k++) threads.emplace_back(run, k);
+    run(0);
+    for (auto& t : threads) t.join();
+    for (auto& e : errors)
+        if (e) std::rethrow_exception(e);
+}
@@ -0,0 +1,63 @@
+#include "THazardPointers.h"
+#include <algorithm>
+
+namespace {
+std::atomic<THazardRecord*> records(nullptr);
+std::atomic<int> recordCount(0);
+
+THazardRecord* AcquireRecord() {
+    for (THazardRecord* rec = records.load(std::memory_order_acquire); rec; rec = rec->next) {
+        bool expected = false;
+        if (!rec->active.load(std::memory_order_relaxed) &&
+            rec->active.compare_exchange_strong(expected, true, std::memory_order_acquire)) return rec;
+    }
+    THazardRecord* rec = new THazardRecord();
+    for (int i = 0; i < HazardSlots; i++) rec->hazard[i].store(nullptr, std::memory_order_relaxed);
+    rec->active.store(true, std::memory_order_relaxed);
+    rec->next = records.load(std::memory_order_relaxed);
+    while (!records.compare_exchange_weak(rec->next, rec, std::memory_order_release, std::memory_order_relaxed));
+    recordCount.fetch_add(1, std::memory_order_relaxed);
+    return rec;
+}
+
+// Запись потока возвращается в общий список при его завершении;
+// неудаленные узлы остаются в ней до следующего владельца
+struct THazardOwner
+{
+    THazardRecord* rec;
+    THazardOwner() : rec(AcquireRecord()) {}
+    ~THazardOwner() {
+        for (int i = 0; i < HazardSlots; i++) THazardPointers::Clear(rec, i);
+        THazardPointers::Scan(rec);
+        rec->active.store(false, std::memory_order_release);
+    }
+};
+}
+
+THazardRecord* THazardPointers::Get() {
+    static thread_local THazardOwner owner;
+    return owner.rec;
+}
+
+void THazardPointers::Retire(THazardRecord* rec, void* p, void (*deleter)(void*)) {
+    rec->retired.emplace_back(p, deleter);
+    if ((int)rec->retired.size() >= 2 * HazardSlots * recordCount.load(std::memory_order_relaxed) + 64) Scan(rec);
+}
+
+void THazardPointers::Scan(THazardRecord* rec) {
+    std::vector<void*> hazards;
+    for (THazardRecord* r = records.load(std::memory_order_acquire); r; r = r->next) {
+        for (int i = 0; i < HazardSlots; i++) {
+            void* p = r->hazard[i].load(std::memory_order_seq_cst);
+            if (p) hazards.push_back(p);
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    std::vector<std::pair<void*, void (*)(void*)>> keep;
+    for (auto& item : rec->retired) {
+        if (std::binary_search(hazards.begin(), hazards.end(), item.first)) keep.push_back(item);
+        else item.second(item.first);
+    }
+    rec->retired.swap(keep);
+}
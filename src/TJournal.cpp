@@ -0,0 +1,150 @@
+#include "TJournal.h"
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TJOURNAL_POSIX 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const char journalMagic[8] = { 'T', 'M', 'J', 'O', 'U', 'R', 'N', 'L' };
+const std::uint32_t journalVersion = 1;
+const std::uint32_t frameMagic = 0x4d52464a; // "JFRM"
+
+std::runtime_error Error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + ": " + path + " (" + std::strerror(errno) + ")");
+}
+}
+
+#ifdef TJOURNAL_POSIX
+namespace {
+void WriteAll(int fd, const char* p, std::size_t bytes, const std::string& path) {
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw Error("Cannot write journal", path);
+        }
+        p += n;
+        bytes -= (std::size_t)n;
+    }
+}
+}
+
+TJournalFile::TJournalFile(const std::string& path_, std::uint32_t elemSize_)
+    : path(path_), fd(-1), elemSize(elemSize_), generation(0), syncCount(0) {}
+
+TJournalFile::~TJournalFile() {
+    if (fd >= 0) ::close(fd);
+}
+
+// Новый журнал пишется рядом и переименовывается поверх старого
+void TJournalFile::Create(std::uint64_t generation_) {
+    TJournalHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, journalMagic, sizeof(header.magic));
+    header.version = journalVersion;
+    header.elemSize = elemSize;
+    header.generation = generation_;
+
+    std::string tmp = path + ".tmp";
+    int newFd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (newFd < 0) throw Error("Cannot create journal", tmp);
+    try {
+        WriteAll(newFd, reinterpret_cast<const char*>(&header), sizeof(header), tmp);
+        if (::fsync(newFd) != 0) throw Error("fsync failed", tmp);
+        if (::rename(tmp.c_str(), path.c_str()) != 0) throw Error("Cannot rename journal", tmp);
+    }
+    catch (...) {
+        ::close(newFd);
+        throw;
+    }
+    SyncDirectory(path);
+    if (fd >= 0) ::close(fd);
+    fd = newFd;
+    generation = generation_;
+}
+
+void TJournalFile::Open(std::uint64_t generation_, std::vector<char>& records) {
+    records.clear();
+    int newFd = ::open(path.c_str(), O_RDWR | O_APPEND);
+    if (newFd < 0) {
+        if (errno != ENOENT) throw Error("Cannot open journal", path);
+        Create(generation_);
+        return;
+    }
+    if (fd >= 0) ::close(fd);
+    fd = newFd;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) throw Error("Cannot stat journal", path);
+    std::vector<char> buf((std::size_t)st.st_size);
+    std::size_t got = 0;
+    while (got < buf.size()) {
+        ssize_t n = ::pread(fd, buf.data() + got, buf.size() - got, (off_t)got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw Error("Cannot read journal", path);
+        got += (std::size_t)n;
+    }
+
+    TJournalHeader header;
+    if (buf.size() < sizeof(header)) {
+        // Сбой до записи заголовка: журнал пуст
+        Create(generation_);
+        return;
+    }
+    std::memcpy(&header, buf.data(), sizeof(header));
+    if (std::memcmp(header.magic, journalMagic, sizeof(journalMagic)) != 0 || header.version != journalVersion)
+        throw std::runtime_error("Not a journal: " + path);
+    if (header.elemSize != elemSize) throw std::runtime_error("Journal element size mismatch: " + path);
+    if (header.generation > generation_) throw std::runtime_error("Journal is newer than snapshot: " + path);
+    if (header.generation < generation_) {
+        Create(generation_);
+        return;
+    }
+    generation = generation_;
+
+    std::size_t pos = sizeof(header);
+    while (pos + sizeof(TJournalFrame) <= buf.size()) {
+        TJournalFrame f;
+        std::memcpy(&f, buf.data() + pos, sizeof(f));
+        std::size_t end = pos + sizeof(f) + f.bytes;
+        if (f.magic != frameMagic || end > buf.size() ||
+            SnapshotChecksum(buf.data() + pos + sizeof(f), f.bytes) != f.checksum)
+            break;
+        records.insert(records.end(), buf.data() + pos + sizeof(f), buf.data() + end);
+        pos = end;
+    }
+    if (pos < buf.size() && ::ftruncate(fd, (off_t)pos) != 0) throw Error("Cannot truncate journal", path);
+}
+
+void TJournalFile::Append(char* frame, std::size_t bytes) {
+    if (fd < 0) throw std::logic_error("journal is not open");
+    TJournalFrame f;
+    f.magic = frameMagic;
+    f.bytes = (std::uint32_t)(bytes - sizeof(f));
+    f.checksum = SnapshotChecksum(frame + sizeof(f), f.bytes);
+    std::memcpy(frame, &f, sizeof(f));
+    WriteAll(fd, frame, bytes, path);
+}
+
+void TJournalFile::Sync() {
+    if (fd >= 0 && ::fsync(fd) != 0) throw Error("fsync failed", path);
+    syncCount++;
+}
+
+void TJournalFile::Reset(std::uint64_t generation_) { Create(generation_); }
+#else
+TJournalFile::TJournalFile(const std::string& path_, std::uint32_t elemSize_)
+    : path(path_), fd(-1), elemSize(elemSize_), generation(0), syncCount(0) {}
+
+TJournalFile::~TJournalFile() {}
+
+void TJournalFile::Create(std::uint64_t) { throw std::runtime_error("journal requires POSIX"); }
+void TJournalFile::Open(std::uint64_t generation_, std::vector<char>&) { Create(generation_); }
+void TJournalFile::Append(char*, std::size_t) { Create(generation); }
+void TJournalFile::Sync() {}
+void TJournalFile::Reset(std::uint64_t generation_) { Create(generation_); }
+#endif
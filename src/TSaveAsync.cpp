@@ -0,0 +1,140 @@
+#include "TSaveAsync.h"
+#include "TSnapshot.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TSAVE_FORK 1
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct TSaveHandle::TState
+{
+    TSaveMode mode;
+    std::string filename;
+    std::mutex m;
+    bool done;
+    bool ok;
+#ifdef TSAVE_FORK
+    pid_t pid;
+#endif
+    std::thread writer;
+    std::atomic<bool> finished;
+    std::exception_ptr error;
+
+    TState(TSaveMode mode_, const std::string& filename_) : mode(mode_), filename(filename_), done(false), ok(false), finished(false) {}
+    ~TState() {
+        try { Finish(true); }
+        catch (...) {}
+    }
+
+    // block == false: только проверка, завершилась ли запись
+    bool Finish(bool block) {
+        std::lock_guard<std::mutex> guard(m);
+        if (done) return true;
+#ifdef TSAVE_FORK
+        if (mode == TSaveMode::Fork) {
+            int status = 0;
+            pid_t r;
+            while ((r = ::waitpid(pid, &status, block ? 0 : WNOHANG)) < 0 && errno == EINTR);
+            if (r == 0) return false;
+            ok = r == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            done = true;
+            return true;
+        }
+#endif
+        if (!block && !finished.load(std::memory_order_acquire)) return false;
+        writer.join();
+        ok = !error;
+        done = true;
+        return true;
+    }
+};
+
+bool TSaveHandle::IsDone() { return !state || state->Finish(false); }
+
+void TSaveHandle::Wait() {
+    if (!state) return;
+    state->Finish(true);
+    if (state->error) std::rethrow_exception(state->error);
+    if (!state->ok) throw std::runtime_error("Async save failed: " + state->filename);
+}
+
+TSaveMode TSaveHandle::GetMode() const { return state ? state->mode : TSaveMode::Auto; }
+
+#ifdef TSAVE_FORK
+namespace {
+// Выполняется в дочернем процессе после fork: только системные вызовы, без выделения памяти
+bool WriteChild(const char* tmp, const char* target, const TSnapshotHeader& header, const void* data, std::size_t bytes) {
+    int fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    const char* parts[2] = { reinterpret_cast<const char*>(&header), static_cast<const char*>(data) };
+    std::size_t sizes[2] = { sizeof(header), bytes };
+    for (int k = 0; k < 2; k++) {
+        const char* p = parts[k];
+        std::size_t left = sizes[k];
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ::close(fd);
+                return false;
+            }
+            p += n;
+            left -= (std::size_t)n;
+        }
+    }
+    bool ok = ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    return ok && ::rename(tmp, target) == 0;
+}
+}
+#endif
+
+TSaveHandle SaveSnapshotAsync(const std::string& filename, const void* data, std::uint32_t elemSize,
+                              std::uint64_t count, std::uint64_t capacity, TSaveMode mode) {
+    std::size_t bytes = (std::size_t)(count * elemSize);
+#ifdef TSAVE_FORK
+    if (mode != TSaveMode::Thread) {
+        std::string tmp = filename + ".tmp";
+        auto state = std::make_shared<TSaveHandle::TState>(TSaveMode::Fork, filename);
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            TSnapshotHeader header = MakeSnapshotHeader(elemSize, count, capacity, data);
+            ::_exit(WriteChild(tmp.c_str(), filename.c_str(), header, data, bytes) ? 0 : 1);
+        }
+        if (pid > 0) {
+            state->pid = pid;
+            return TSaveHandle(state);
+        }
+        state->done = true;
+        if (mode == TSaveMode::Fork) throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+    }
+#else
+    if (mode == TSaveMode::Fork) throw std::runtime_error("fork is not supported on this platform");
+#endif
+    // Копия снимается в вызывающем потоке, контрольная сумма и запись - в фоновом
+    std::shared_ptr<char> copy(new char[bytes ? bytes : 1], std::default_delete<char[]>());
+    if (bytes) std::memcpy(copy.get(), data, bytes);
+    auto state = std::make_shared<TSaveHandle::TState>(TSaveMode::Thread, filename);
+    TSaveHandle::TState* raw = state.get();
+    raw->writer = std::thread([raw, copy, elemSize, count, capacity]() {
+        try {
+            TSnapshotHeader header = MakeSnapshotHeader(elemSize, count, capacity, copy.get());
+            WriteSnapshotFile(raw->filename, header, copy.get(), true);
+        }
+        catch (...) {
+            raw->error = std::current_exception();
+        }
+        raw->finished.store(true, std::memory_order_release);
+    });
+    return TSaveHandle(state);
+}
@@ -0,0 +1,133 @@
+#include "TSimdMin.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TSIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+template <class T>
+using TMinKernel = T (*)(const T*, int);
+
+template <class T>
+T ScalarMin(const T* data, int count) {
+    T m = data[0];
+    for (int i = 1; i < count; i++)
+        if (data[i] < m) m = data[i];
+    return m;
+}
+
+#ifdef TSIMD_X86
+// Ядро: 4 независимых аккумулятора, инициализированных data[0]; MIN(x, acc) оставляет acc,
+// если x - NaN, поэтому порядок аргументов важен
+#define TSIMD_MIN_KERNEL(NAME, TARGET, T, VEC, LANES, LOAD, STORE, SET1, MIN)  \
+__attribute__((target(TARGET))) T NAME(const T* data, int count) {             \
+    VEC a0 = SET1(data[0]), a1 = a0, a2 = a0, a3 = a0;                          \
+    int i = 0;                                                                 \
+    for (; i + 4 * LANES <= count; i += 4 * LANES) {                           \
+        a0 = MIN(LOAD(data + i), a0);                                          \
+        a1 = MIN(LOAD(data + i + LANES), a1);                                  \
+        a2 = MIN(LOAD(data + i + 2 * LANES), a2);                              \
+        a3 = MIN(LOAD(data + i + 3 * LANES), a3);                              \
+    }                                                                          \
+    for (; i + LANES <= count; i += LANES) a0 = MIN(LOAD(data + i), a0);       \
+    a0 = MIN(a1, a0);                                                          \
+    a2 = MIN(a3, a2);                                                          \
+    a0 = MIN(a2, a0);                                                          \
+    T lanes[LANES];                                                            \
+    STORE(lanes, a0);                                                          \
+    T m = lanes[0];                                                            \
+    for (int j = 1; j < LANES; j++)                                            \
+        if (lanes[j] < m) m = lanes[j];                                        \
+    for (; i < count; i++)                                                     \
+        if (data[i] < m) m = data[i];                                          \
+    return m;                                                                  \
+}
+
+#define TSIMD_LOAD128(p) _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))
+#define TSIMD_STORE128(p, v) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v)
+#define TSIMD_LOAD256(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+#define TSIMD_STORE256(p, v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v)
+
+__attribute__((target("sse4.2"))) inline __m128i Min64Sse(__m128i x, __m128i acc) {
+    return _mm_blendv_epi8(acc, x, _mm_cmpgt_epi64(acc, x));
+}
+
+__attribute__((target("avx2"))) inline __m256i Min64Avx2(__m256i x, __m256i acc) {
+    return _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(acc, x));
+}
+
+TSIMD_MIN_KERNEL(MinI32Sse, "sse4.2", std::int32_t, __m128i, 4, TSIMD_LOAD128, TSIMD_STORE128, _mm_set1_epi32, _mm_min_epi32)
+TSIMD_MIN_KERNEL(MinI64Sse, "sse4.2", std::int64_t, __m128i, 2, TSIMD_LOAD128, TSIMD_STORE128, _mm_set1_epi64x, Min64Sse)
+TSIMD_MIN_KERNEL(MinF32Sse, "sse4.2", float, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_min_ps)
+TSIMD_MIN_KERNEL(MinF64Sse, "sse4.2", double, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_min_pd)
+
+TSIMD_MIN_KERNEL(MinI32Avx2, "avx2", std::int32_t, __m256i, 8, TSIMD_LOAD256, TSIMD_STORE256, _mm256_set1_epi32, _mm256_min_epi32)
+TSIMD_MIN_KERNEL(MinI64Avx2, "avx2", std::int64_t, __m256i, 4, TSIMD_LOAD256, TSIMD_STORE256, _mm256_set1_epi64x, Min64Avx2)
+TSIMD_MIN_KERNEL(MinF32Avx2, "avx2", float, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_min_ps)
+TSIMD_MIN_KERNEL(MinF64Avx2, "avx2", double, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_min_pd)
+
+// _mm512_min_* и _mm512_reduce_min_* в GCC 12 дают ложные -Wuninitialized
+// и -Wmaybe-uninitialized (_mm512_undefined_*)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+TSIMD_MIN_KERNEL(MinI32Avx512, "avx512f", std::int32_t, __m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi32, _mm512_min_epi32)
+TSIMD_MIN_KERNEL(MinI64Avx512, "avx512f", std::int64_t, __m512i, 8, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_set1_epi64, _mm512_min_epi64)
+TSIMD_MIN_KERNEL(MinF32Avx512, "avx512f", float, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_min_ps)
+TSIMD_MIN_KERNEL(MinF64Avx512, "avx512f", double, __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_min_pd)
+#pragma GCC diagnostic pop
+
+enum TIsa { Scalar, Sse42, Avx2, Avx512 };
+
+TIsa DetectIsa() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Avx512;
+    if (__builtin_cpu_supports("avx2")) return Avx2;
+    if (__builtin_cpu_supports("sse4.2")) return Sse42;
+    return Scalar;
+}
+
+template <class T>
+TMinKernel<T> Select(TMinKernel<T> avx512, TMinKernel<T> avx2, TMinKernel<T> sse42) {
+    switch (DetectIsa()) {
+    case Avx512: return avx512;
+    case Avx2: return avx2;
+    case Sse42: return sse42;
+    default: return ScalarMin<T>;
+    }
+}
+#define TSIMD_SELECT(T, SUFFIX) Select<T>(Min##SUFFIX##Avx512, Min##SUFFIX##Avx2, Min##SUFFIX##Sse)
+#else
+#define TSIMD_SELECT(T, SUFFIX) ScalarMin<T>
+#endif
+}
+
+std::int32_t SimdMin(const std::int32_t* data, int count) {
+    static const TMinKernel<std::int32_t> kernel = TSIMD_SELECT(std::int32_t, I32);
+    return kernel(data, count);
+}
+
+std::int64_t SimdMin(const std::int64_t* data, int count) {
+    static const TMinKernel<std::int64_t> kernel = TSIMD_SELECT(std::int64_t, I64);
+    return kernel(data, count);
+}
+
+float SimdMin(const float* data, int count) {
+    static const TMinKernel<float> kernel = TSIMD_SELECT(float, F32);
+    return kernel(data, count);
+}
+
+double SimdMin(const double* data, int count) {
+    static const TMinKernel<double> kernel = TSIMD_SELECT(double, F64);
+    return kernel(data, count);
+}
+
+const char* SimdMinIsa() {
+#ifdef TSIMD_X86
+    static const char* names[] = { "scalar", "sse4.2", "avx2", "avx512f" };
+    return names[DetectIsa()];
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,253 @@
+#include "TSnapshot.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TSNAPSHOT_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const std::uint64_t fnvPrime = 1099511628211ULL;
+}
+
+std::uint64_t SnapshotChecksum(const void* data, std::size_t bytes, std::uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = seed;
+    std::size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = (h ^ word) * fnvPrime;
+    }
+    for (; i < bytes; i++) h = (h ^ p[i]) * fnvPrime;
+    return h;
+}
+
+TSnapshotHeader MakeSnapshotHeader(std::uint32_t elemSize, std::uint64_t count, std::uint64_t capacity, const void* data) {
+    TSnapshotHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, SnapshotMagic, sizeof(h.magic));
+    h.version = 1;
+    h.headerSize = sizeof(TSnapshotHeader);
+    h.elemSize = elemSize;
+    h.count = count;
+    h.capacity = capacity;
+    h.checksum = SnapshotChecksum(data, (std::size_t)(count * elemSize));
+    return h;
+}
+
+#ifdef TSNAPSHOT_POSIX
+namespace {
+void WriteAll(int fd, const void* data, std::size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        p += n;
+        bytes -= (std::size_t)n;
+    }
+}
+}
+
+void SyncDirectory(const std::string& filename) {
+    std::string::size_type slash = filename.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+void WriteSnapshotFile(const std::string& filename, const TSnapshotHeader& header, const void* data, bool durable) {
+    std::string target = durable ? filename + ".tmp" : filename;
+    int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + target);
+    try {
+        WriteAll(fd, &header, sizeof(header));
+        WriteAll(fd, data, (std::size_t)(header.count * header.elemSize));
+        if (durable && ::fsync(fd) != 0) throw std::runtime_error("fsync failed: " + target);
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    if (!durable) return;
+    if (::rename(target.c_str(), filename.c_str()) != 0) throw std::runtime_error("Cannot rename file: " + target);
+    SyncDirectory(filename);
+}
+#else
+void SyncDirectory(const std::string&) {}
+
+void WriteSnapshotFile(const std::string& filename, const TSnapshotHeader& header, const void* data, bool) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(static_cast<const char*>(data), (std::streamsize)(header.count * header.elemSize));
+    if (!file) throw std::runtime_error("Cannot write file: " + filename);
+}
+#endif
+
+bool ReadSnapshotHeader(std::istream& in, TSnapshotHeader& header) {
+    std::streampos start = in.tellg();
+    if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) == 0)
+        return true;
+    in.clear();
+    in.seekg(start);
+    return false;
+}
+
+void CheckSnapshotHeader(const TSnapshotHeader& header, std::uint32_t elemSize, std::uint64_t maxCount) {
+    if (header.version == 0 || header.version > SnapshotVersion)
+        throw std::runtime_error("Unsupported snapshot version: " + std::to_string(header.version));
+    if (header.headerSize != sizeof(TSnapshotHeader)) throw std::runtime_error("Bad snapshot header size");
+    if (header.elemSize != elemSize) throw std::runtime_error("Snapshot element size mismatch");
+    if (header.count > header.capacity || header.capacity > maxCount) throw std::runtime_error("Bad snapshot count");
+}
+
+void CheckSnapshotData(const TSnapshotHeader& header, const void* data) {
+    if (SnapshotChecksum(data, (std::size_t)(header.count * header.elemSize)) != header.checksum)
+        throw std::runtime_error("Snapshot checksum mismatch");
+}
+
+namespace {
+const char textHeaderTag[] = "#TStack";
+}
+
+void WriteTextHeader(std::ostream& out, std::uint64_t count, std::uint64_t capacity) {
+    out << textHeaderTag << " count=" << count << " capacity=" << capacity << '\n';
+}
+
+bool ReadTextHeader(std::istream& in, std::uint64_t& count, std::uint64_t& capacity) {
+    const std::size_t tagLen = sizeof(textHeaderTag) - 1;
+    std::streampos start = in.tellg();
+    char tag[sizeof(textHeaderTag)] = {};
+    if (!in.read(tag, tagLen) || std::memcmp(tag, textHeaderTag, tagLen) != 0) {
+        in.clear();
+        in.seekg(start);
+        return false;
+    }
+    std::string line;
+    std::getline(in, line);
+    unsigned long long c = 0, cap = 0;
+    if (std::sscanf(line.c_str(), " count=%llu capacity=%llu", &c, &cap) != 2)
+        throw std::runtime_error("Bad text header: " + line);
+    count = c;
+    capacity = cap;
+    return true;
+}
+
+void WriteShardManifest(const std::string& filename, const TShardManifest& m) {
+    std::ofstream file(filename);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    int stacks = (int)m.begins.size(), shards = (int)m.files.size();
+    file << "#TMultiStack version=1 elemSize=" << m.elemSize << " len=" << m.len
+         << " stacks=" << stacks << " shards=" << shards << '\n';
+    for (int i = 0; i < stacks; i++) file << "stack " << i << " begin=" << m.begins[i] << " top=" << m.tops[i] << '\n';
+    for (int k = 0; k < shards; k++) file << "shard " << k << " first=" << m.firstStacks[k] << " file=" << m.files[k] << '\n';
+    if (!file) throw std::runtime_error("Cannot write file: " + filename);
+}
+
+TShardManifest ReadShardManifest(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    auto bad = [&filename]() { return std::runtime_error("Bad manifest: " + filename); };
+
+    std::string line;
+    unsigned version = 0, elemSize = 0;
+    int len = 0, stacks = 0, shards = 0;
+    if (!std::getline(file, line) ||
+        std::sscanf(line.c_str(), "#TMultiStack version=%u elemSize=%u len=%d stacks=%d shards=%d",
+                    &version, &elemSize, &len, &stacks, &shards) != 5)
+        throw bad();
+    if (version != 1 || len < 0 || stacks <= 0 || shards <= 0 || shards > stacks) throw bad();
+
+    TShardManifest m;
+    m.elemSize = elemSize;
+    m.len = len;
+    m.begins.resize(stacks);
+    m.tops.resize(stacks);
+    for (int i = 0; i < stacks; i++) {
+        int index;
+        if (!std::getline(file, line) ||
+            std::sscanf(line.c_str(), "stack %d begin=%d top=%d", &index, &m.begins[i], &m.tops[i]) != 3 || index != i)
+            throw bad();
+        // Первый подстек, как и в памяти, начинается с нуля
+        if ((i == 0 && m.begins[0] != 0) || (i > 0 && m.begins[i] < m.tops[i - 1]) || m.tops[i] < m.begins[i] || m.tops[i] > len)
+            throw bad();
+    }
+    m.firstStacks.resize(shards + 1);
+    m.files.resize(shards);
+    for (int k = 0; k < shards; k++) {
+        int index;
+        char name[256];
+        if (!std::getline(file, line) ||
+            std::sscanf(line.c_str(), "shard %d first=%d file=%255s", &index, &m.firstStacks[k], name) != 3 || index != k)
+            throw bad();
+        if ((k == 0 && m.firstStacks[k] != 0) || (k > 0 && m.firstStacks[k] <= m.firstStacks[k - 1]) ||
+            m.firstStacks[k] >= stacks)
+            throw bad();
+        m.files[k] = name;
+    }
+    m.firstStacks[shards] = stacks;
+    return m;
+}
+
+std::string SiblingPath(const std::string& filename, const std::string& name) {
+    std::string::size_type slash = filename.rfind('/');
+    return slash == std::string::npos ? name : filename.substr(0, slash + 1) + name;
+}
+
+#ifdef TSNAPSHOT_POSIX
+TSnapshotMapping::TSnapshotMapping(const std::string& filename, TMapMode mode_, std::uint32_t elemSize, std::uint64_t maxCount, bool verify)
+    : addr(nullptr), size(0), mode(mode_) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(TSnapshotHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a snapshot: " + filename);
+    }
+    size = (std::size_t)st.st_size;
+    int prot = mode == TMapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* p = ::mmap(nullptr, size, prot, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("Cannot map file: " + filename);
+    addr = p;
+    try {
+        std::memcpy(&header, addr, sizeof(header));
+        if (std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0)
+            throw std::runtime_error("Not a snapshot: " + filename);
+        CheckSnapshotHeader(header, elemSize, maxCount);
+        if (header.flags != 0) throw std::runtime_error("Compressed snapshot cannot be mapped: " + filename);
+        if (size < sizeof(TSnapshotHeader) + header.count * elemSize)
+            throw std::runtime_error("Snapshot is truncated: " + filename);
+        if (verify) CheckSnapshotData(header, GetData());
+    }
+    catch (...) {
+        ::munmap(addr, size);
+        throw;
+    }
+}
+
+TSnapshotMapping::~TSnapshotMapping() { ::munmap(addr, size); }
+#else
+TSnapshotMapping::TSnapshotMapping(const std::string&, TMapMode mode_, std::uint32_t, std::uint64_t, bool)
+    : addr(nullptr), size(0), mode(mode_) {
+    throw std::runtime_error("mmap is not supported on this platform");
+}
+
+TSnapshotMapping::~TSnapshotMapping() {}
+#endif
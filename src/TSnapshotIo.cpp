@@ -0,0 +1,444 @@
+#include "TSnapshotIo.h"
+#include "TSnapshotIoTesting.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#define TIO_POSIX 1
+#define TIO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define TIO_POSIX 1
+#endif
+
+#ifdef TIO_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::size_t RoundUp(std::size_t n, std::size_t align) { return (n + align - 1) / align * align; }
+
+std::runtime_error IoError(const std::string& what, const std::string& filename, int err) {
+    return std::runtime_error(what + ": " + filename + " (" + std::strerror(err) + ")");
+}
+
+void CheckOptions(const TIoOptions& options) {
+    if (options.queueDepth <= 0) throw std::invalid_argument("queueDepth <= 0");
+    if (options.chunkLen == 0 || options.chunkLen % IoAlign != 0) throw std::invalid_argument("chunkLen is not a multiple of IoAlign");
+}
+
+TIoBackend StreamWrite(const std::string& filename, const void* head, std::size_t headBytes, const void* data, std::size_t dataBytes) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    file.write(static_cast<const char*>(head), (std::streamsize)headBytes);
+    file.write(static_cast<const char*>(data), (std::streamsize)dataBytes);
+    if (!file) throw std::runtime_error("Cannot write file: " + filename);
+    return TIoBackend::Stream;
+}
+
+TIoBackend StreamRead(const std::string& filename, std::size_t offset, void* data, std::size_t bytes) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Cannot open file: " + filename);
+    file.seekg((std::streamoff)offset);
+    file.read(static_cast<char*>(data), (std::streamsize)bytes);
+    if (!file) throw std::runtime_error("File is truncated: " + filename);
+    return TIoBackend::Stream;
+}
+}
+
+#ifdef TIO_POSIX
+namespace {
+class TAlignedBuffer
+{
+protected:
+    char* p;
+public:
+    explicit TAlignedBuffer(std::size_t n) : p(nullptr) {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, IoAlign, std::max(n, IoAlign)) != 0) throw std::bad_alloc();
+        p = static_cast<char*>(mem);
+    }
+    TAlignedBuffer(const TAlignedBuffer&) = delete;
+    TAlignedBuffer& operator=(const TAlignedBuffer&) = delete;
+    ~TAlignedBuffer() { std::free(p); }
+    char* Get() const { return p; }
+};
+
+// Один запрос: need - сколько байт должно прийти минимум (чтение у конца файла короче len)
+struct TIoRequest
+{
+    std::size_t offset;
+    char* buf;
+    std::size_t len;
+    std::size_t need;
+};
+
+// Блок i готовится в prepare (на буфере staging длины chunkLen), после выполнения - finish
+struct TIoJob
+{
+    bool write;
+    std::size_t count;
+    std::function<TIoRequest(std::size_t i, char* staging)> prepare;
+    std::function<void(std::size_t i, char* staging)> finish;
+};
+
+void RunPwrite(int fd, const TIoJob& job, const TIoOptions& options, const std::string& filename) {
+    int threadCount = (int)std::min<std::size_t>(std::min(options.queueDepth, 64), job.count);
+    std::atomic<std::size_t> next(0);
+    std::atomic<int> error(0);
+    auto run = [&]() {
+        TAlignedBuffer staging(options.chunkLen);
+        for (std::size_t i = next++; i < job.count && !error; i = next++) {
+            TIoRequest r = job.prepare(i, staging.Get());
+            std::size_t done = 0;
+            while (done < r.len) {
+                ssize_t n = job.write ? ::pwrite(fd, r.buf + done, r.len - done, (off_t)(r.offset + done))
+                                      : ::pread(fd, r.buf + done, r.len - done, (off_t)(r.offset + done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) {
+                    error = errno;
+                    return;
+                }
+                if (n == 0) break;
+                done += (std::size_t)n;
+            }
+            if (done < r.need) {
+                error = EIO;
+                return;
+            }
+            if (job.finish) job.finish(i, staging.Get());
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int k = 1; k < threadCount; k++) threads.emplace_back(run);
+    run();
+    for (auto& t : threads) t.join();
+    if (error) throw IoError(job.write ? "Cannot write file" : "Cannot read file", filename, error);
+}
+
+#ifdef TIO_URING
+std::atomic<bool> uringOpsDisabled(false);
+
+// IORING_OP_WRITE/READ появились в 5.6 вместе с IORING_REGISTER_PROBE; на 5.1-5.5
+// кольцо создается, но запросы завершаются с -EINVAL, поэтому опкоды проверяются заранее
+bool ProbeUringOps(int ringFd) {
+    if (uringOpsDisabled) return false;
+    const unsigned opCount = 256;
+    std::vector<char> buf(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+    if (::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, opCount) < 0) return false;
+    unsigned ops[] = { IORING_OP_WRITE, IORING_OP_READ };
+    for (unsigned op : ops)
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+    return true;
+}
+
+// Кольца io_uring, отображенные в память; SQE заполняются напрямую, без liburing
+class TUring
+{
+protected:
+    int fd;
+    void* sqRing;
+    std::size_t sqRingLen;
+    void* cqRing;
+    std::size_t cqRingLen;
+    io_uring_sqe* sqes;
+    std::size_t sqesLen;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    unsigned queued;
+public:
+    TUring() : fd(-1), sqRing(MAP_FAILED), sqRingLen(0), cqRing(MAP_FAILED), cqRingLen(0),
+               sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), sqesLen(0), queued(0) {}
+    TUring(const TUring&) = delete;
+    TUring& operator=(const TUring&) = delete;
+    ~TUring() {
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqesLen);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqRingLen);
+        if (sqRing != MAP_FAILED) ::munmap(sqRing, sqRingLen);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool Init(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd = (int)::syscall(__NR_io_uring_setup, entries, &p);
+        if (fd < 0 || !ProbeUringOps(fd)) return false;
+        sqRingLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingLen = cqRingLen = std::max(sqRingLen, cqRingLen);
+        sqRing = ::mmap(nullptr, sqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) return false;
+        cqRing = single ? sqRing : ::mmap(nullptr, cqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) return false;
+        sqesLen = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) return false;
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    void Queue(bool write, int file, const TIoRequest& r, unsigned long long userData) {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = file;
+        sqe->addr = (unsigned long long)(std::uintptr_t)r.buf;
+        sqe->len = (unsigned)r.len;
+        sqe->off = r.offset;
+        sqe->user_data = userData;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        queued++;
+    }
+
+    // Отправляет накопленные SQE и ждет хотя бы wait завершений
+    int Enter(unsigned wait) {
+        int r;
+        do r = (int)::syscall(__NR_io_uring_enter, fd, queued, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        while (r < 0 && errno == EINTR);
+        if (r < 0) return errno;
+        queued -= std::min<unsigned>(queued, (unsigned)r);
+        return 0;
+    }
+
+    bool Pop(io_uring_cqe& cqe) {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+        cqe = cqes[head & *cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+// false, если io_uring недоступен (ядро, seccomp) и нужен запасной бэкенд
+bool RunUring(int fd, const TIoJob& job, const TIoOptions& options, const std::string& filename) {
+    unsigned depth = (unsigned)std::min<std::size_t>((std::size_t)options.queueDepth, job.count);
+    TUring ring;
+    if (!ring.Init(depth)) return false;
+
+    struct TSlot
+    {
+        std::size_t chunk;
+        TIoRequest req;
+        std::size_t done;
+    };
+    std::vector<TSlot> slots(depth);
+    std::vector<std::unique_ptr<TAlignedBuffer>> staging(depth);
+    std::vector<unsigned> freeSlots;
+    for (unsigned s = 0; s < depth; s++) {
+        staging[s].reset(new TAlignedBuffer(options.chunkLen));
+        freeSlots.push_back(s);
+    }
+    std::size_t next = 0;
+    unsigned inflight = 0;
+    int error = 0;
+    while (inflight > 0 || (next < job.count && !error)) {
+        while (!error && next < job.count && !freeSlots.empty()) {
+            unsigned s = freeSlots.back();
+            freeSlots.pop_back();
+            slots[s].chunk = next;
+            slots[s].req = job.prepare(next, staging[s]->Get());
+            slots[s].done = 0;
+            ring.Queue(job.write, fd, slots[s].req, s);
+            next++;
+            inflight++;
+        }
+        int err = ring.Enter(1);
+        if (err) {
+            // io_uring_enter отклонен (например, seccomp): пока ни один запрос не выполнен,
+            // еще можно перейти на pwrite
+            if (next == inflight && (err == EINVAL || err == EOPNOTSUPP || err == ENOSYS || err == EPERM)) return false;
+            throw IoError("io_uring_enter failed", filename, err);
+        }
+        io_uring_cqe cqe;
+        while (ring.Pop(cqe)) {
+            TSlot& slot = slots[cqe.user_data];
+            if (cqe.res < 0 || (cqe.res == 0 && slot.done < slot.req.need)) {
+                if (!error) error = cqe.res < 0 ? -cqe.res : EIO;
+            }
+            else if (cqe.res > 0 && slot.done + (std::size_t)cqe.res < slot.req.len && !error) {
+                // Короткая операция: остаток отправляется тем же слотом
+                slot.done += (std::size_t)cqe.res;
+                TIoRequest rest = { slot.req.offset + slot.done, slot.req.buf + slot.done, slot.req.len - slot.done, 0 };
+                ring.Queue(job.write, fd, rest, cqe.user_data);
+                continue;
+            }
+            else if (!error && job.finish) job.finish(slot.chunk, staging[cqe.user_data]->Get());
+            freeSlots.push_back((unsigned)cqe.user_data);
+            inflight--;
+        }
+    }
+    if (error) throw IoError(job.write ? "Cannot write file" : "Cannot read file", filename, error);
+    return true;
+}
+#endif
+
+TIoBackend Run(int fd, const TIoJob& job, const TIoOptions& options, const std::string& filename) {
+    if (job.count == 0) return options.backend;
+#ifdef TIO_URING
+    if (options.backend == TIoBackend::IoUring && RunUring(fd, job, options, filename)) return TIoBackend::IoUring;
+#endif
+    RunPwrite(fd, job, options, filename);
+    return TIoBackend::Pwrite;
+}
+
+int OpenFile(const std::string& filename, int flags, bool& direct) {
+    int fd = -1;
+#ifdef O_DIRECT
+    if (direct) {
+        fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0 || errno != EINVAL) return fd;
+        direct = false;
+    }
+#else
+    direct = false;
+#endif
+    return ::open(filename.c_str(), flags, 0644);
+}
+}
+
+void DisableIoUringOps(bool disabled) {
+#ifdef TIO_URING
+    uringOpsDisabled = disabled;
+#else
+    (void)disabled;
+#endif
+}
+
+bool IsIoUringAvailable() {
+#ifdef TIO_URING
+    TUring ring;
+    return ring.Init(1);
+#else
+    return false;
+#endif
+}
+
+// Блок i - байты файла [i * chunkLen, ...). Блоки, целиком лежащие в data, пишутся
+// прямо из нее; первый блок (с head) и все блоки в режиме O_DIRECT собираются в выровненном буфере
+TIoBackend WriteFileRange(const std::string& filename, const void* head, std::size_t headBytes,
+                          const void* data, std::size_t dataBytes, const TIoOptions& options) {
+    CheckOptions(options);
+    if (options.backend == TIoBackend::Stream) return StreamWrite(filename, head, headBytes, data, dataBytes);
+    bool direct = options.direct;
+    int fd = OpenFile(filename, O_WRONLY | O_CREAT | O_TRUNC, direct);
+    if (fd < 0) throw IoError("Cannot open file", filename, errno);
+
+    const char* h = static_cast<const char*>(head);
+    const char* d = static_cast<const char*>(data);
+    std::size_t total = headBytes + dataBytes, chunk = options.chunkLen;
+    TIoJob job;
+    job.write = true;
+    job.count = (total + chunk - 1) / chunk;
+    job.prepare = [=](std::size_t i, char* staging) {
+        std::size_t off = i * chunk, len = std::min(chunk, total - off);
+        if (!direct && off >= headBytes) return TIoRequest{ off, const_cast<char*>(d + (off - headBytes)), len, len };
+        std::size_t n = 0;
+        if (off < headBytes) {
+            n = std::min(headBytes - off, len);
+            std::memcpy(staging, h + off, n);
+        }
+        if (n < len) std::memcpy(staging + n, d + (off + n - headBytes), len - n);
+        if (direct) {
+            std::size_t padded = RoundUp(len, IoAlign);
+            std::memset(staging + len, 0, padded - len);
+            len = padded;
+        }
+        return TIoRequest{ off, staging, len, len };
+    };
+    TIoBackend used;
+    try {
+        used = Run(fd, job, options, filename);
+        if (direct && ::ftruncate(fd, (off_t)total) != 0) throw IoError("Cannot truncate file", filename, errno);
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) throw IoError("Cannot write file", filename, errno);
+    return used;
+}
+
+// Блоки выровнены по chunkLen от начала файла; без O_DIRECT они читаются прямо в data,
+// с O_DIRECT - в выровненный буфер, откуда копируется нужная часть
+TIoBackend ReadFileRange(const std::string& filename, std::size_t offset, void* data, std::size_t bytes,
+                         const TIoOptions& options) {
+    CheckOptions(options);
+    if (options.backend == TIoBackend::Stream) return StreamRead(filename, offset, data, bytes);
+    bool direct = options.direct;
+    int fd = OpenFile(filename, O_RDONLY, direct);
+    if (fd < 0) throw IoError("Cannot open file", filename, errno);
+
+    char* d = static_cast<char*>(data);
+    std::size_t chunk = options.chunkLen, end = offset + bytes, first = offset / chunk;
+    TIoJob job;
+    job.write = false;
+    job.count = bytes ? (end + chunk - 1) / chunk - first : 0;
+    job.prepare = [=](std::size_t i, char* staging) {
+        std::size_t lo = (first + i) * chunk, hi = std::min(lo + chunk, end);
+        if (!direct) {
+            std::size_t from = std::max(lo, offset);
+            return TIoRequest{ from, d + (from - offset), hi - from, hi - from };
+        }
+        return TIoRequest{ lo, staging, RoundUp(hi - lo, IoAlign), hi - lo };
+    };
+    if (direct)
+        job.finish = [=](std::size_t i, char* staging) {
+            std::size_t lo = (first + i) * chunk, hi = std::min(lo + chunk, end), from = std::max(lo, offset);
+            std::memcpy(d + (from - offset), staging + (from - lo), hi - from);
+        };
+    TIoBackend used;
+    try { used = Run(fd, job, options, filename); }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return used;
+}
+#else
+void DisableIoUringOps(bool) {}
+
+bool IsIoUringAvailable() { return false; }
+
+TIoBackend WriteFileRange(const std::string& filename, const void* head, std::size_t headBytes,
+                          const void* data, std::size_t dataBytes, const TIoOptions& options) {
+    CheckOptions(options);
+    return StreamWrite(filename, head, headBytes, data, dataBytes);
+}
+
+TIoBackend ReadFileRange(const std::string& filename, std::size_t offset, void* data, std::size_t bytes,
+                         const TIoOptions& options) {
+    CheckOptions(options);
+    return StreamRead(filename, offset, data, bytes);
+}
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+
+// Внутренний заголовок для тестов TSnapshotIo, в include/ не входит.
+// Считать опкоды io_uring неподдерживаемыми, как на ядрах 5.1-5.5 (проверка отката на Pwrite)
+void DisableIoUringOps(bool disabled);
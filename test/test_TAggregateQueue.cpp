@@ -0,0 +1,54 @@
+#include "TAggregateQueue.h"
+#include <gtest.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+
+TEST(TAggregateQueue, pops_in_fifo_order)
+{
+    TAggregateQueue<int, TSumOp<int>> q;
+    for (int i = 0; i < 5; i++) q.Push(i);
+    EXPECT_EQ(0, q.Pop());
+    q.Push(5);
+    for (int i = 1; i <= 5; i++) EXPECT_EQ(i, q.Pop());
+    EXPECT_TRUE(q.IsEmpty());
+    ASSERT_ANY_THROW(q.Pop());
+    ASSERT_ANY_THROW(q.Aggregate());
+}
+
+TEST(TAggregateQueue, sliding_window_min_max_match_naive)
+{
+    const int window = 7;
+    TAggregateQueue<int, TMinOp<int>, TMaxOp<int>> q;
+    std::deque<int> ref;
+    unsigned seed = 1;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1664525 + 1013904223;
+        int v = (int)(seed >> 16) % 1000;
+        q.Push(v);
+        ref.push_back(v);
+        if (q.GetCount() > window) {
+            EXPECT_EQ(ref.front(), q.Pop());
+            ref.pop_front();
+        }
+        EXPECT_EQ(*std::min_element(ref.begin(), ref.end()), q.Aggregate<0>());
+        EXPECT_EQ(*std::max_element(ref.begin(), ref.end()), q.Aggregate<1>());
+    }
+}
+
+struct TConcatOp
+{
+    std::string operator()(const std::string& a, const std::string& b) const { return a + b; }
+};
+
+TEST(TAggregateQueue, keeps_order_for_non_commutative_operation)
+{
+    TAggregateQueue<std::string, TConcatOp> q;
+    q.Push("a");
+    q.Push("b");
+    q.Push("c");
+    EXPECT_EQ("a", q.Pop());
+    q.Push("d");
+    EXPECT_EQ("bcd", q.Aggregate());
+    EXPECT_EQ("b", q.Front());
+}
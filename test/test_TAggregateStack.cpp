@@ -0,0 +1,52 @@
+#include "TAggregateStack.h"
+#include <gtest.h>
+#include <sstream>
+#include <string>
+
+TEST(TAggregateStack, throws_when_aggregate_empty_stack)
+{
+    TAggregateStack<int, TSumOp<int>> st(4);
+    ASSERT_ANY_THROW(st.Aggregate());
+}
+
+TEST(TAggregateStack, keeps_several_aggregates_at_once)
+{
+    TAggregateStack<int, TMinOp<int>, TMaxOp<int>, TSumOp<int>, TXorOp<int>, TGcdOp<int>> st(8);
+    int values[] = { 12, 18, 6, 30 };
+    for (int v : values) st.Push(v);
+    EXPECT_EQ(6, st.Aggregate<0>());
+    EXPECT_EQ(30, st.Aggregate<TMaxOp<int>>());
+    EXPECT_EQ(66, st.Aggregate<TSumOp<int>>());
+    EXPECT_EQ(12 ^ 18 ^ 6 ^ 30, st.Aggregate<TXorOp<int>>());
+    EXPECT_EQ(6, st.Aggregate<TGcdOp<int>>());
+    EXPECT_EQ(30, st.Pop());
+    EXPECT_EQ(18, st.Aggregate<TMaxOp<int>>());
+    EXPECT_EQ(36, st.Aggregate<TSumOp<int>>());
+}
+
+struct TConcatOp
+{
+    std::string operator()(const std::string& a, const std::string& b) const { return a + b; }
+};
+
+TEST(TAggregateStack, supports_custom_non_commutative_operation)
+{
+    TAggregateStack<std::string, TConcatOp> st(4);
+    st.Push("a");
+    st.Push("b");
+    st.Push("c");
+    EXPECT_EQ("abc", st.Aggregate());
+    st.Pop();
+    EXPECT_EQ("ab", st.Aggregate());
+    EXPECT_EQ("b", st.Top());
+}
+
+TEST(TAggregateStack, prints_elements_from_bottom)
+{
+    TAggregateStack<int, TSumOp<int>> st(4);
+    st.Push(1);
+    st.Push(2);
+    std::stringstream ss;
+    ss << st;
+    EXPECT_EQ("TAggregateStack[len=4, top=2]\nData: 1, 2\n", ss.str());
+}
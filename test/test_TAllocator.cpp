@@ -0,0 +1,78 @@
+#include "TMultiStack.h"
+#include "TChunkedStack.h"
+#include "TAllocator.h"
+#include <gtest.h>
+#include <string>
+
+TEST(TPoolAllocator, reuses_freed_blocks)
+{
+    typedef TPoolAllocator<int, 16> TPool;
+    TPool alloc;
+    int* a = alloc.allocate(16);
+    alloc.deallocate(a, 16);
+    int freeCount = TPool::GetFreeCount();
+    int* b = alloc.allocate(16);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(freeCount - 1, TPool::GetFreeCount());
+    alloc.deallocate(b, 16);
+}
+
+TEST(TPoolAllocator, chunked_stack_recycles_chunks)
+{
+    typedef TPoolAllocator<int, 8> TPool;
+    TChunkedStack<int, TPool> st(8);
+    for (int i = 0; i < 64; i++) st.Push(i);
+    for (int i = 63; i >= 0; i--) EXPECT_EQ(i, st.Pop());
+    EXPECT_LE(6, TPool::GetFreeCount());
+}
+
+TEST(TPoolAllocator, can_be_used_by_stack)
+{
+    TStack<std::string, TPoolAllocator<std::string, 4>> st(4);
+    st.Push("a");
+    st.Push("b");
+    EXPECT_EQ("b", st.Pop());
+}
+
+TEST(TArena, rolls_back_lifo_deallocation)
+{
+    TArena arena(1024);
+    void* a = arena.Allocate(100, 8);
+    std::size_t used = arena.GetUsed();
+    void* b = arena.Allocate(200, 8);
+    arena.Deallocate(b, 200);
+    EXPECT_EQ(used, arena.GetUsed());
+    EXPECT_EQ(b, arena.Allocate(200, 8));
+    arena.Deallocate(a, 100);
+    EXPECT_LT(used, arena.GetUsed());
+}
+
+TEST(TArena, adds_blocks_and_resets)
+{
+    TArena arena(256);
+    for (int i = 0; i < 10; i++) arena.Allocate(200, 16);
+    EXPECT_EQ(10, arena.GetBlockCount());
+    arena.Reset();
+    EXPECT_EQ(1, arena.GetBlockCount());
+    EXPECT_EQ(0u, arena.GetUsed());
+}
+
+TEST(TArenaAllocator, can_be_used_by_stacks)
+{
+    TArena arena;
+    TArenaAllocator<int> alloc(arena);
+    TStack<int, TArenaAllocator<int>> st(4, alloc);
+    st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    TMultiStack<int, TArenaAllocator<int>> ms(2, 8, alloc);
+    ms.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    for (int i = 0; i < 10; i++) st.Push(i), ms.Push(i % 2, i);
+    EXPECT_EQ(9, st.Pop());
+    EXPECT_EQ(9, ms.Pop(1));
+    TChunkedStack<int, TArenaAllocator<int>> cs(4, alloc);
+    cs.Push(1);
+    std::size_t used = arena.GetUsed();
+    for (int i = 0; i < 4; i++) cs.Push(i);
+    cs.Pop();
+    cs.ShrinkToFit();
+    EXPECT_EQ(used, arena.GetUsed());
+}
@@ -0,0 +1,118 @@
+#include "TBlockCodec.h"
+#include "TMultiStack.h"
+#include <gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+template <class T>
+static void CheckRoundTrip(TBlockCodec codec, const std::vector<T>& values)
+{
+    std::vector<char> buf;
+    EncodeBlock(codec, values.data(), (int)values.size(), buf);
+    std::vector<T> decoded(values.size());
+    DecodeBlock(codec, buf.data(), buf.size(), decoded.data(), (int)decoded.size());
+    EXPECT_EQ(values, decoded);
+}
+
+template <class T>
+static void CheckExtremes()
+{
+    std::vector<T> v = { std::numeric_limits<T>::max(), std::numeric_limits<T>::min(), 0, 1,
+                         std::numeric_limits<T>::max(), std::numeric_limits<T>::min(), (T)-1 };
+    CheckRoundTrip(TBlockCodec::DeltaVarint, v);
+    CheckRoundTrip(TBlockCodec::FrameOfReference, v);
+}
+
+TEST(TBlockCodec, round_trips_extreme_values)
+{
+    CheckExtremes<std::int8_t>();
+    CheckExtremes<std::uint16_t>();
+    CheckExtremes<std::int32_t>();
+    CheckExtremes<std::int64_t>();
+    CheckExtremes<std::uint64_t>();
+}
+
+TEST(TBlockCodec, round_trips_every_bit_width)
+{
+    for (int width = 0; width <= 64; width++) {
+        std::vector<std::uint64_t> v;
+        std::uint64_t seed = 99;
+        for (int i = 0; i < 37; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            v.push_back(width == 64 ? seed : seed & ((1ULL << width) - 1));
+        }
+        CheckRoundTrip(TBlockCodec::FrameOfReference, v);
+        CheckRoundTrip(TBlockCodec::DeltaVarint, v);
+    }
+}
+
+TEST(TBlockCodec, rejects_truncated_block)
+{
+    std::vector<int> v = { 1, 1000, 100000, 7 };
+    std::vector<char> buf;
+    EncodeBlock(TBlockCodec::DeltaVarint, v.data(), 4, buf);
+    ASSERT_ANY_THROW(DecodeBlock(TBlockCodec::DeltaVarint, buf.data(), buf.size() - 1, v.data(), 4));
+    buf.clear();
+    EncodeBlock(TBlockCodec::FrameOfReference, v.data(), 4, buf);
+    ASSERT_ANY_THROW(DecodeBlock(TBlockCodec::FrameOfReference, buf.data(), buf.size() - 1, v.data(), 4));
+}
+
+TEST(TBlockCodec, compressed_stack_files_load_and_are_small)
+{
+    TStack<long long> st(200000);
+    for (int i = 0; i < 150000; i++) st.Push(1000000 + i * 3 + (i % 7));
+    TFileFormat formats[] = { TFileFormat::DeltaVarint, TFileFormat::FrameOfReference };
+    for (TFileFormat format : formats) {
+        const char* name = "codec_stack.bin";
+        st.SaveToFile(name, format);
+        std::ifstream f(name, std::ios::binary | std::ios::ate);
+        EXPECT_LT((long long)f.tellg(), 150000LL * 8 / 2);
+        f.close();
+
+        TStack<long long> loaded;
+        loaded.LoadFromFile(name);
+        EXPECT_EQ(200000, loaded.GetLen());
+        EXPECT_TRUE(st == loaded);
+
+        TStack<long long> mapped;
+        ASSERT_ANY_THROW(mapped.MapFile(name));
+        std::remove(name);
+    }
+}
+
+TEST(TBlockCodec, rejects_index_past_end_of_file)
+{
+    const char* name = "codec_bad_index.bin";
+    TStack<int> st(16);
+    for (int i = 0; i < 10; i++) st.Push(i);
+    st.SaveToFile(name, TFileFormat::DeltaVarint);
+    {
+        // Один блок: последнее смещение индекса лежит сразу за первым, после заголовка
+        std::fstream f(name, std::ios::binary | std::ios::in | std::ios::out);
+        std::uint64_t huge = 1ULL << 40;
+        f.seekp(sizeof(TSnapshotHeader) + 8);
+        f.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    TStack<int> loaded;
+    EXPECT_THROW(loaded.LoadFromFile(name), std::runtime_error);
+    std::remove(name);
+}
+
+TEST(TBlockCodec, compressed_format_requires_integers)
+{
+    TStack<double> st(2);
+    st.Push(1.5);
+    ASSERT_ANY_THROW(st.SaveToFile("codec_double.bin", TFileFormat::DeltaVarint));
+    std::remove("codec_double.bin");
+}
+
+TEST(TBlockCodec, parallel_for_visits_each_index_once_and_rethrows)
+{
+    std::vector<int> hits(1000, 0);
+    ParallelFor(1000, [&hits](int i) { hits[i]++; }, 4);
+    for (int h : hits) EXPECT_EQ(1, h);
+    ASSERT_ANY_THROW(ParallelFor(100, [](int i) { if (i == 50) throw std::runtime_error("fail"); }, 4));
+}
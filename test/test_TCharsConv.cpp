@@ -0,0 +1,104 @@
+#include "TCharsConv.h"
+#include <gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(TCharsConv, char_and_bool_are_left_to_streams)
+{
+    EXPECT_TRUE(THasCharsConv<int>::value);
+    EXPECT_TRUE(THasCharsConv<unsigned long long>::value);
+    EXPECT_TRUE(THasCharsConv<double>::value);
+    EXPECT_FALSE(THasCharsConv<char>::value);
+    EXPECT_FALSE(THasCharsConv<bool>::value);
+    EXPECT_FALSE(THasCharsConv<std::string>::value);
+}
+
+TEST(TCharsConv, parse_requires_whole_token)
+{
+    int v = 0;
+    EXPECT_TRUE(ParseChars("+42", "+42" + 3, v));
+    EXPECT_EQ(42, v);
+    EXPECT_FALSE(ParseChars("12x", "12x" + 3, v));
+    double d = 0;
+    EXPECT_TRUE(ParseChars("-1.5e3", "-1.5e3" + 6, d));
+    EXPECT_EQ(-1500.0, d);
+}
+
+TEST(TCharsConv, reads_numbers_across_block_boundaries)
+{
+    std::stringstream ss;
+    for (int i = 0; i < 50000; i++) ss << i * 7 - 100000 << (i % 5 ? " " : "\r\n");
+    std::vector<int> values;
+    ReadNumbers<int>(ss, [&values](int v) { values.push_back(v); });
+    ASSERT_EQ(50000u, values.size());
+    for (int i = 0; i < 50000; i++) EXPECT_EQ(i * 7 - 100000, values[i]);
+}
+
+TEST(TCharsConv, stops_at_first_bad_token)
+{
+    std::stringstream ss("1 2 three 4");
+    std::vector<long> values;
+    ReadNumbers<long>(ss, [&values](long v) { values.push_back(v); });
+    EXPECT_EQ(2u, values.size());
+}
+
+template <class T>
+static void ExpectSameAsStream(const std::vector<T>& values, std::ios_base::fmtflags flags, int precision)
+{
+    std::ostringstream fast, slow;
+    fast.flags(flags);
+    slow.flags(flags);
+    fast.precision(precision);
+    slow.precision(precision);
+    ASSERT_TRUE(WriteNumbers(fast, values.data(), (int)values.size(), ", "));
+    for (std::size_t i = 0; i < values.size(); i++) slow << (i ? ", " : "") << values[i];
+    EXPECT_EQ(slow.str(), fast.str());
+}
+
+TEST(TCharsConv, write_matches_stream_formatting)
+{
+    std::vector<long long> ints = { 0, -1, 42, -9223372036854775807LL - 1, 9223372036854775807LL };
+    ExpectSameAsStream(ints, std::ios_base::dec, 6);
+    std::vector<double> doubles = { 0.0, -0.0, 1.0, 0.1, 1e-7, 123456789.0, 1e300, -2.5e-300, 1.0 / 3 };
+    ExpectSameAsStream(doubles, std::ios_base::dec, 6);
+    ExpectSameAsStream(doubles, std::ios_base::dec, 17);
+    ExpectSameAsStream(doubles, std::ios_base::dec, 0);
+    ExpectSameAsStream(doubles, std::ios_base::dec | std::ios_base::scientific, 3);
+    ExpectSameAsStream(std::vector<double>{ 0.5, -12.25, 1e10 }, std::ios_base::dec | std::ios_base::fixed, 2);
+    ExpectSameAsStream(std::vector<float>{ 0.1f, 3.4e38f, -1e-30f }, std::ios_base::dec, 6);
+
+    std::ostringstream hex, padded;
+    hex << std::hex;
+    padded.width(5);
+    EXPECT_FALSE(WriteNumbers(hex, ints.data(), 1, ", "));
+    EXPECT_FALSE(WriteNumbers(padded, ints.data(), 1, ", "));
+}
+
+TEST(TCharsConv, read_chars_matches_stream_extraction)
+{
+    std::istringstream in(" 12 -7\n+5 -1 3x");
+    int a = 0, b = 0, c = 0;
+    EXPECT_TRUE(ReadChars(in, a) && ReadChars(in, b) && ReadChars(in, c));
+    EXPECT_EQ(12, a);
+    EXPECT_EQ(-7, b);
+    EXPECT_EQ(5, c);
+    unsigned u = 0;
+    EXPECT_TRUE(ReadChars(in, u));
+    EXPECT_EQ(~0u, u);
+    // Как и operator>>, число заканчивается на первом постороннем символе
+    EXPECT_TRUE(ReadChars(in, a));
+    EXPECT_EQ(3, a);
+    EXPECT_EQ('x', in.get());
+    EXPECT_FALSE(ReadChars(in, a));
+    EXPECT_TRUE(in.fail() && in.eof());
+
+    std::istringstream floats("1.5e-3 2E+2 7");
+    double d = 0;
+    EXPECT_TRUE(ReadChars(floats, d));
+    EXPECT_EQ(1.5e-3, d);
+    EXPECT_TRUE(ReadChars(floats, d));
+    EXPECT_EQ(200.0, d);
+    EXPECT_TRUE(ReadChars(floats, d));
+    EXPECT_TRUE(floats.eof() && !floats.fail());
+}
@@ -0,0 +1,60 @@
+#include "TChunkedStack.h"
+#include <gtest.h>
+#include <string>
+
+TEST(TChunkedStack, throws_when_create_with_wrong_chunk_len)
+{
+    ASSERT_ANY_THROW(TChunkedStack<int> st(0));
+}
+
+TEST(TChunkedStack, can_push_and_pop_across_chunks)
+{
+    TChunkedStack<int> st(4);
+    for (int i = 0; i < 10; i++) st.Push(i);
+    EXPECT_EQ(10, st.GetCount());
+    EXPECT_EQ(3, st.GetChunkCount());
+    for (int i = 9; i >= 0; i--) EXPECT_EQ(i, st.Pop());
+    EXPECT_TRUE(st.IsEmpty());
+    ASSERT_ANY_THROW(st.Pop());
+}
+
+TEST(TChunkedStack, growth_does_not_move_elements)
+{
+    TChunkedStack<int> st(8);
+    st.Push(42);
+    int* first = &st[0];
+    for (int i = 0; i < 1000; i++) st.Push(i);
+    EXPECT_EQ(first, &st[0]);
+    EXPECT_EQ(42, *first);
+}
+
+TEST(TChunkedStack, keeps_one_spare_chunk_after_pop)
+{
+    TChunkedStack<int> st(2);
+    for (int i = 0; i < 6; i++) st.Push(i);
+    for (int i = 0; i < 5; i++) st.Pop();
+    EXPECT_EQ(2, st.GetChunkCount());
+    st.ShrinkToFit();
+    EXPECT_EQ(1, st.GetChunkCount());
+}
+
+TEST(TChunkedStack, copy_is_equal_and_independent)
+{
+    TChunkedStack<std::string> st(3);
+    for (int i = 0; i < 7; i++) st.Push(std::to_string(i));
+    TChunkedStack<std::string> copy(st);
+    EXPECT_TRUE(copy == st);
+    copy.Pop();
+    EXPECT_TRUE(copy != st);
+    EXPECT_EQ("6", st.Pop());
+}
+
+TEST(TChunkedStack, can_find_min)
+{
+    TChunkedStack<int> st(2);
+    st.Push(5);
+    st.Push(3);
+    st.Push(-1);
+    st.Push(7);
+    EXPECT_EQ(-1, st.FindMin());
+}
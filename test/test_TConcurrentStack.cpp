@@ -0,0 +1,57 @@
+#include "TConcurrentStack.h"
+#include <gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TConcurrentStack, can_push_and_pop_in_lifo_order)
+{
+    TConcurrentStack<int> st;
+    EXPECT_TRUE(st.IsEmpty());
+    st.Push(1);
+    st.Push(2);
+    EXPECT_EQ(2, st.Pop());
+    EXPECT_EQ(1, st.Pop());
+    ASSERT_ANY_THROW(st.Pop());
+}
+
+static void CheckConcurrentPushPop(TConcurrentStack<int>& st)
+{
+    const int threads = 4, n = 20000;
+    std::vector<long long> sums(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            for (int i = 0; i < n; i++) {
+                st.Push(t * n + i);
+                int v;
+                if (st.TryPop(v)) sums[t] += v;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    long long total = 0;
+    int v;
+    while (st.TryPop(v)) total += v;
+    for (long long s : sums) total += s;
+    long long all = (long long)threads * n;
+    EXPECT_EQ(all * (all - 1) / 2, total);
+}
+
+TEST(TConcurrentStack, concurrent_push_and_pop_lose_nothing)
+{
+    TConcurrentStack<int> st;
+    CheckConcurrentPushPop(st);
+}
+
+TEST(TConcurrentStack, throws_when_create_with_wrong_elimination_params)
+{
+    ASSERT_ANY_THROW(TConcurrentStack<int> st(-1));
+    ASSERT_ANY_THROW(TConcurrentStack<int> st(4, -1));
+}
+
+TEST(TConcurrentStack, elimination_loses_nothing)
+{
+    TConcurrentStack<int> st(4, 64);
+    EXPECT_EQ(4, st.GetEliminationSize());
+    CheckConcurrentPushPop(st);
+}
@@ -0,0 +1,53 @@
+#include "TFlatCombiningStack.h"
+#include <gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TFlatCombiningStack, throws_when_create_with_wrong_slot_count)
+{
+    ASSERT_ANY_THROW(TFlatCombiningStack<int> st(0));
+}
+
+TEST(TFlatCombiningStack, can_push_and_pop_in_lifo_order)
+{
+    TFlatCombiningStack<int> st(4, 1);
+    st.Push(1);
+    st.Push(2);
+    EXPECT_EQ(2, st.GetCount());
+    EXPECT_EQ(2, st.Pop());
+    EXPECT_EQ(1, st.Pop());
+    EXPECT_TRUE(st.IsEmpty());
+    ASSERT_ANY_THROW(st.Pop());
+}
+
+TEST(TFlatCombiningStack, rethrows_error_of_sequential_stack)
+{
+    TFlatCombiningStack<int> st(4, 1, TGrowthPolicy::None());
+    st.Push(1);
+    ASSERT_ANY_THROW(st.Push(2));
+    EXPECT_EQ(1, st.Pop());
+}
+
+TEST(TFlatCombiningStack, concurrent_push_and_pop_lose_nothing)
+{
+    const int threads = 4, n = 20000;
+    TFlatCombiningStack<int> st(8);
+    std::vector<long long> sums(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            for (int i = 0; i < n; i++) {
+                st.Push(t * n + i);
+                int v;
+                if (st.TryPop(v)) sums[t] += v;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    long long total = 0;
+    int v;
+    while (st.TryPop(v)) total += v;
+    for (long long s : sums) total += s;
+    long long all = (long long)threads * n;
+    EXPECT_EQ(all * (all - 1) / 2, total);
+}
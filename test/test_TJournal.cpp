@@ -0,0 +1,129 @@
+#include "TJournal.h"
+#include <gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+static void RemoveJournal(const std::string& path)
+{
+    std::remove((path + ".snap").c_str());
+    std::remove((path + ".journal").c_str());
+}
+
+static std::string ReadAll(const std::string& name)
+{
+    std::ifstream f(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+TEST(TJournaledStack, recovers_operations_from_journal)
+{
+    std::string path = "journal_recover";
+    RemoveJournal(path);
+    {
+        TJournalOptions opt;
+        opt.groupSize = 4;
+        TJournaledStack<int> st(path, opt);
+        for (int i = 0; i < 10; i++) st.Push(i);
+        EXPECT_EQ(9, st.Pop());
+        EXPECT_EQ(8, st.Pop());
+    }
+    TJournaledStack<int> st(path);
+    ASSERT_EQ(8, st.GetCount());
+    EXPECT_EQ(12, st.GetJournalCount());
+    for (int i = 7; i >= 0; i--) EXPECT_EQ(i, st.Pop());
+    RemoveJournal(path);
+}
+
+TEST(TJournaledStack, sync_flushes_frames_when_sync_every_is_zero)
+{
+    std::string path = "journal_sync_zero";
+    RemoveJournal(path);
+    {
+        TJournalOptions opt;
+        opt.groupSize = 2;
+        opt.syncEvery = 0;
+        TJournaledStack<int> st(path, opt);
+        std::uint64_t before = st.GetSyncCount();
+        for (int i = 0; i < 10; i++) st.Push(i);
+        EXPECT_EQ(before, st.GetSyncCount());
+        st.Sync();
+        EXPECT_EQ(before + 1, st.GetSyncCount());
+        // Нечего сбрасывать - fsync не нужен
+        st.Sync();
+        EXPECT_EQ(before + 1, st.GetSyncCount());
+        st.Push(10);
+        st.Sync();
+        EXPECT_EQ(before + 2, st.GetSyncCount());
+    }
+    RemoveJournal(path);
+}
+
+TEST(TJournaledStack, drops_torn_tail_of_journal)
+{
+    std::string path = "journal_torn";
+    RemoveJournal(path);
+    {
+        TJournaledStack<long long> st(path);
+        st.Push(1);
+        st.Push(2);
+    }
+    {
+        std::ofstream f(path + ".journal", std::ios::binary | std::ios::app);
+        f.write("\x4a\x46\x52\x4d\x40\x00\x00\x00garbage", 15);
+    }
+    TJournaledStack<long long> st(path);
+    EXPECT_EQ(2, st.GetCount());
+    st.Push(3);
+    st.Sync();
+    TJournaledStack<long long> again(path);
+    EXPECT_EQ(3, again.GetCount());
+    EXPECT_EQ(3, again.Top());
+    RemoveJournal(path);
+}
+
+TEST(TJournaledStack, compaction_writes_snapshot_and_starts_new_generation)
+{
+    std::string path = "journal_compact";
+    RemoveJournal(path);
+    {
+        TJournalOptions opt;
+        opt.compactEvery = 100;
+        TJournaledStack<double> st(path, opt);
+        for (int i = 0; i < 250; i++) st.Push(i * 0.5);
+        // Кадры по 64 операции: сжатие после второго кадра, затем еще кадр и 58 незафиксированных
+        EXPECT_EQ(1u, st.GetGeneration());
+        EXPECT_EQ(122, st.GetJournalCount());
+    }
+    // Фиксация в деструкторе довела журнал до порога и сжала его еще раз
+    TJournaledStack<double> st(path);
+    EXPECT_EQ(2u, st.GetGeneration());
+    EXPECT_EQ(0, st.GetJournalCount());
+    ASSERT_EQ(250, st.GetCount());
+    EXPECT_EQ(124.5, st.Top());
+    RemoveJournal(path);
+}
+
+TEST(TJournaledStack, ignores_stale_journal_after_interrupted_compaction)
+{
+    std::string path = "journal_stale";
+    RemoveJournal(path);
+    std::string oldJournal;
+    {
+        TJournaledStack<int> st(path);
+        for (int i = 0; i < 5; i++) st.Push(i);
+        st.Sync();
+        oldJournal = ReadAll(path + ".journal");
+        st.Compact();
+    }
+    // Сбой между записью снимка и заменой журнала оставляет журнал прошлого поколения
+    {
+        std::ofstream f(path + ".journal", std::ios::binary | std::ios::trunc);
+        f << oldJournal;
+    }
+    TJournaledStack<int> st(path);
+    EXPECT_EQ(5, st.GetCount());
+    EXPECT_EQ(0, st.GetJournalCount());
+    RemoveJournal(path);
+}
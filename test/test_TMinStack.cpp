@@ -0,0 +1,53 @@
+#include "TMinStack.h"
+#include <gtest.h>
+#include <string>
+
+TEST(TMinStack, throws_when_find_min_in_empty_stack)
+{
+    TMinStack<int> st(4);
+    ASSERT_ANY_THROW(st.FindMin());
+}
+
+TEST(TMinStack, pop_restores_previous_min)
+{
+    TMinStack<int> st(8);
+    int values[] = { 5, 3, 7, 3, 1, 4 };
+    int mins[] = { 5, 3, 3, 3, 1, 1 };
+    for (int i = 0; i < 6; i++) {
+        st.Push(values[i]);
+        EXPECT_EQ(mins[i], st.FindMin());
+    }
+    for (int i = 5; i > 0; i--) {
+        EXPECT_EQ(values[i], st.Pop());
+        EXPECT_EQ(mins[i - 1], st.FindMin());
+    }
+}
+
+TEST(TMinStack, keeps_fixed_capacity_without_growth)
+{
+    TMinStack<std::string> st(2);
+    st.Push("b");
+    st.Push("a");
+    EXPECT_TRUE(st.IsFull());
+    ASSERT_ANY_THROW(st.Push("c"));
+    EXPECT_EQ("a", st.FindMin());
+    st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    st.Push("c");
+    EXPECT_EQ(3, st.GetCount());
+}
+
+TEST(TMinMultiStack, tracks_min_of_each_sub_stack)
+{
+    TMinMultiStack<int> ms(3, 12);
+    ms.Push(0, 4);
+    ms.Push(1, 9);
+    ms.Push(0, 2);
+    ms.Push(1, 10);
+    for (int k = 0; k < 8; k++) ms.Push(2, 100 - k);
+    EXPECT_EQ(2, ms.FindMin(0));
+    EXPECT_EQ(9, ms.FindMin(1));
+    EXPECT_EQ(93, ms.FindMin(2));
+    EXPECT_EQ(2, ms.Pop(0));
+    EXPECT_EQ(4, ms.FindMin(0));
+    ASSERT_ANY_THROW(TMinMultiStack<int>(2, 4).FindMin(1));
+}
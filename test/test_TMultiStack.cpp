@@ -2,3 +2,271 @@
 #include <gtest.h>
 #include <fstream>
 #include <sstream>
+
+TEST(TStack, can_push_and_pop_in_lifo_order)
+{
+    TStack<int> st(3);
+    st.Push(1);
+    st.Push(2);
+    st.Push(3);
+    EXPECT_TRUE(st.IsFull());
+    ASSERT_ANY_THROW(st.Push(4));
+    EXPECT_EQ(3, st.Pop());
+    EXPECT_EQ(2, st.Pop());
+    EXPECT_EQ(1, st.Pop());
+    ASSERT_ANY_THROW(st.Pop());
+}
+
+TEST(TStack, stores_non_trivial_elements)
+{
+    TStack<std::string> st(2);
+    st.Push("first");
+    st.Push(std::string(100, 'x'));
+    TStack<std::string> copy(st);
+    st.Resize(5);
+    EXPECT_EQ(std::string(100, 'x'), st.Pop());
+    EXPECT_EQ(2, copy.GetCount());
+    EXPECT_EQ("first", st.Pop());
+}
+
+TEST(TStack, copies_values_from_pointer_array)
+{
+    int a = 1, b = 2;
+    int* ptrs[3] = { &a, &b, nullptr };
+    TStack<int> st(ptrs, 3);
+    EXPECT_EQ(2, st.GetCount());
+    EXPECT_EQ(3, st.GetLen());
+    EXPECT_EQ(2, st.Pop());
+    EXPECT_EQ(2, b);
+}
+
+TEST(TStack, can_work_over_external_buffer)
+{
+    int buf[4] = { 5, 6, 0, 0 };
+    {
+        TStack<int> st(buf, 4, 2);
+        st.Push(7);
+        EXPECT_EQ(3, st.GetCount());
+        EXPECT_EQ(7, buf[2]);
+        st.Resize(8);
+        st.Push(8);
+        EXPECT_EQ(8, st.Pop());
+    }
+    EXPECT_EQ(5, buf[0]);
+}
+
+TEST(TStack, can_read_from_stream)
+{
+    std::stringstream ss("3 4 5 6");
+    TStack<int> st;
+    ss >> st;
+    EXPECT_EQ(3, st.GetLen());
+    EXPECT_EQ(6, st.Pop());
+    EXPECT_EQ(4, st.FindMin());
+}
+
+TEST(TStack, grows_geometrically_when_policy_is_set)
+{
+    TStack<int> st(2);
+    st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    for (int i = 0; i < 100; i++) st.Push(i);
+    EXPECT_EQ(128, st.GetLen());
+    EXPECT_EQ(100, st.GetHighWater());
+    for (int i = 99; i >= 0; i--) EXPECT_EQ(i, st.Pop());
+    EXPECT_EQ(100, st.GetHighWater());
+}
+
+TEST(TStack, set_data_keeps_high_water_and_growth)
+{
+    int a = 1, b = 2;
+    int* ptrs[] = { &a, &b, nullptr };
+    TStack<int> copied(ptrs, 3);
+    EXPECT_EQ(2, copied.GetCount());
+    EXPECT_EQ(2, copied.GetHighWater());
+
+    int buf[4] = { 5, 6, 7, 8 };
+    TStack<int> st(100);
+    for (int i = 0; i < 50; i++) st.Push(i);
+    st.SetData(buf, 4, 3);
+    EXPECT_EQ(3, st.GetHighWater());
+
+    st.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    st.SetData(ptrs, 2);
+    st.Push(3);
+    EXPECT_EQ(3, st.GetHighWater());
+    EXPECT_EQ(4, st.GetLen());
+}
+
+TEST(TStack, grows_by_fixed_increment)
+{
+    TStack<int> st;
+    st.SetGrowthPolicy(TGrowthPolicy::Increment(10));
+    for (int i = 0; i < 11; i++) st.Push(i);
+    EXPECT_EQ(20, st.GetLen());
+}
+
+TEST(TStack, capped_growth_throws_at_cap)
+{
+    TStack<int> st(1);
+    st.SetGrowthPolicy(TGrowthPolicy::Capped(5));
+    for (int i = 0; i < 5; i++) st.Push(i);
+    EXPECT_EQ(5, st.GetLen());
+    ASSERT_ANY_THROW(st.Push(5));
+}
+
+TEST(TMultiStack, can_create_multistack)
+{
+    ASSERT_NO_THROW(TMultiStack<int> ms(3, 12));
+}
+
+TEST(TMultiStack, throws_when_create_with_wrong_params)
+{
+    ASSERT_ANY_THROW(TMultiStack<int> ms(0, 12));
+    ASSERT_ANY_THROW(TMultiStack<int> ms(3, -1));
+}
+
+TEST(TMultiStack, stacks_are_independent)
+{
+    TMultiStack<int> ms(3, 12);
+    ms.Push(0, 1);
+    ms.Push(2, 5);
+    ms.Push(2, 6);
+    EXPECT_EQ(1, ms.GetCount(0));
+    EXPECT_TRUE(ms.IsEmpty(1));
+    EXPECT_EQ(6, ms.Pop(2));
+    EXPECT_EQ(5, ms.Pop(2));
+    EXPECT_EQ(1, ms.Pop(0));
+}
+
+TEST(TMultiStack, one_stack_can_use_whole_buffer)
+{
+    TMultiStack<int> ms(4, 8);
+    ms.Push(3, -1);
+    for (int i = 0; i < 7; i++) ms.Push(1, i);
+    EXPECT_TRUE(ms.IsFull());
+    ASSERT_ANY_THROW(ms.Push(0, 100));
+    for (int i = 6; i >= 0; i--) EXPECT_EQ(i, ms.Pop(1));
+    EXPECT_EQ(-1, ms.Pop(3));
+}
+
+TEST(TMultiStack, throws_when_index_is_out_of_range)
+{
+    TMultiStack<int> ms(2, 4);
+    ASSERT_ANY_THROW(ms.Push(2, 1));
+    ASSERT_ANY_THROW(ms.Pop(-1));
+}
+
+TEST(TMultiStack, throws_when_pop_from_empty_stack)
+{
+    TMultiStack<int> ms(2, 4);
+    ASSERT_ANY_THROW(ms.Pop(0));
+}
+
+TEST(TMultiStack, copied_multistack_is_equal_and_independent)
+{
+    TMultiStack<std::string> ms(2, 4);
+    ms.Push(0, "a");
+    ms.Push(1, "b");
+    TMultiStack<std::string> copy(ms);
+    EXPECT_TRUE(copy == ms);
+    copy.Push(1, "c");
+    EXPECT_TRUE(copy != ms);
+    EXPECT_EQ(1, ms.GetCount(1));
+}
+
+TEST(TMultiStack, can_find_min_in_sub_stack)
+{
+    TMultiStack<int> ms(2, 10);
+    ms.Push(0, 4);
+    ms.Push(0, 2);
+    ms.Push(1, 1);
+    EXPECT_EQ(2, ms.FindMin(0));
+    ASSERT_ANY_THROW(TMultiStack<int>(2, 2).FindMin(0));
+}
+
+TEST(TMultiStack, repacking_keeps_elements_of_all_stacks)
+{
+    const int n = 5;
+    TMultiStack<int> ms(n, 50);
+    std::vector<std::vector<int>> ref(n);
+    unsigned seed = 12345;
+    for (int step = 0; step < 2000; step++) {
+        seed = seed * 1103515245 + 12345;
+        int i = (seed >> 8) % n;
+        bool push = ((seed >> 4) % 3) != 0;
+        if (push && !ms.IsFull()) {
+            ms.Push(i, step);
+            ref[i].push_back(step);
+        }
+        else if (!ref[i].empty()) {
+            EXPECT_EQ(ref[i].back(), ms.Pop(i));
+            ref[i].pop_back();
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ((int)ref[i].size(), ms.GetCount(i));
+        for (int j = (int)ref[i].size() - 1; j >= 0; j--) EXPECT_EQ(ref[i][j], ms.Pop(i));
+    }
+}
+
+TEST(TMultiStack, hot_stack_takes_space_from_idle_stacks)
+{
+    TMultiStack<int> ms(4, 100);
+    for (int i = 0; i < 4; i++) ms.Push(i, i);
+    for (int k = 0; k < 96; k++) ms.Push(2, k);
+    EXPECT_EQ(97, ms.GetCount(2));
+    EXPECT_TRUE(ms.IsFull());
+    ASSERT_ANY_THROW(ms.Push(2, 0));
+    for (int i = 0; i < 4; i++) EXPECT_EQ(i == 2 ? 95 : i, ms.Pop(i));
+}
+
+TEST(TMultiStack, grows_whole_region_when_policy_is_set)
+{
+    TMultiStack<int> ms(3, 6);
+    ms.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    for (int k = 0; k < 20; k++) ms.Push(k % 3, k);
+    EXPECT_EQ(24, ms.GetLen());
+    EXPECT_EQ(20, ms.GetHighWater());
+    for (int k = 19; k >= 0; k--) EXPECT_EQ(k, ms.Pop(k % 3));
+}
+
+TEST(TMultiStack, find_min_all_returns_per_stack_and_global_min)
+{
+    TMultiStack<int> ms(4, 100);
+    for (int k = 0; k < 30; k++) ms.Push(k % 3 == 0 ? 0 : 2, 50 - k * (k % 3 == 0 ? 1 : 3));
+    TStackAggregates<int> res = ms.FindMinAll();
+    EXPECT_EQ(0, res.empty[0]);
+    EXPECT_EQ(1, res.empty[1]);
+    EXPECT_EQ(0, res.empty[2]);
+    EXPECT_EQ(1, res.empty[3]);
+    EXPECT_EQ(23, res.values[0]);
+    EXPECT_EQ(-37, res.values[2]);
+    EXPECT_TRUE(res.hasTotal);
+    EXPECT_EQ(-37, res.total);
+}
+
+TEST(TMultiStack, parallel_aggregate_all_matches_serial)
+{
+    int n = 1000;
+    TMultiStack<long long> ms(n, 200000);
+    for (int k = 0; k < 150000; k++) ms.Push((k * 7919) % n, (k * 104729LL) % 1000003 - 500000);
+    auto sum = [](long long a, long long b) { return a + b; };
+    TStackAggregates<long long> serial = ms.AggregateAll(sum, 1);
+    TStackAggregates<long long> parallel = ms.AggregateAll(sum, 4);
+    EXPECT_EQ(serial.values, parallel.values);
+    EXPECT_EQ(serial.total, parallel.total);
+    TStackAggregates<long long> mins = ms.FindMinAll(4);
+    for (int i = 0; i < n; i++) {
+        if (!mins.empty[i]) {
+            EXPECT_EQ(ms.FindMin(i), mins.values[i]);
+        }
+    }
+}
+
+TEST(TMultiStack, aggregate_all_of_empty_multistack_has_no_total)
+{
+    TMultiStack<int> ms(3, 10);
+    TStackAggregates<int> res = ms.FindMinAll();
+    EXPECT_FALSE(res.hasTotal);
+    EXPECT_EQ(3, (int)res.values.size());
+}
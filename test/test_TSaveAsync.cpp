@@ -0,0 +1,56 @@
+#include "TMultiStack.h"
+#include <gtest.h>
+#include <cstdio>
+#include <string>
+
+static void CheckSaveKeepsSnapshot(TSaveMode mode, const char* name)
+{
+    TStack<int> st(1 << 20);
+    for (int i = 0; i < (1 << 20); i++) st.Push(i);
+    TStack<int> expected(st);
+
+    TSaveHandle h = st.SaveAsync(name, mode);
+    // Изменения после запуска сохранения в снимок не попадают
+    for (int i = 0; i < 1000; i++) st.Pop();
+    for (int i = 0; i < 1000; i++) st.Push(-i);
+    h.Wait();
+    EXPECT_TRUE(h.IsDone());
+
+    TStack<int> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_TRUE(expected == loaded);
+    std::remove(name);
+}
+
+TEST(TSaveAsync, thread_mode_saves_frozen_state)
+{
+    CheckSaveKeepsSnapshot(TSaveMode::Thread, "save_async_thread.bin");
+}
+
+TEST(TSaveAsync, auto_mode_saves_frozen_state)
+{
+    CheckSaveKeepsSnapshot(TSaveMode::Auto, "save_async_auto.bin");
+}
+
+TEST(TSaveAsync, wait_reports_failure)
+{
+    TStack<int> st(4);
+    st.Push(1);
+    TSaveMode modes[] = { TSaveMode::Auto, TSaveMode::Thread };
+    for (TSaveMode mode : modes) {
+        TSaveHandle h = st.SaveAsync("no_such_dir/save_async.bin", mode);
+        ASSERT_ANY_THROW(h.Wait());
+    }
+}
+
+TEST(TSaveAsync, dropped_handle_finishes_save)
+{
+    const char* name = "save_async_dropped.bin";
+    TStack<double> st(10);
+    st.Push(2.5);
+    st.SaveAsync(name);
+    TStack<double> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(2.5, loaded.Top());
+    std::remove(name);
+}
@@ -0,0 +1,73 @@
+#include "TShardedStack.h"
+#include <gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TShardedStack, throws_when_create_with_wrong_params)
+{
+    ASSERT_ANY_THROW(TShardedStack<int> st(0, 16));
+    ASSERT_ANY_THROW(TShardedStack<int> st(2, 16, 0));
+}
+
+TEST(TShardedStack, pops_own_shard_in_lifo_order)
+{
+    TShardedStack<int> st(2, 8);
+    st.Push(0, 1);
+    st.Push(0, 2);
+    st.Push(1, 3);
+    EXPECT_EQ(2, st.Pop(0));
+    EXPECT_EQ(1, st.Pop(0));
+    EXPECT_EQ(1, st.GetCount(1));
+}
+
+TEST(TShardedStack, steals_batch_from_other_shard)
+{
+    TShardedStack<int> st(2, 32, 4);
+    for (int i = 0; i < 10; i++) st.Push(0, i);
+    EXPECT_EQ(9, st.Pop(1));
+    EXPECT_EQ(3, st.GetCount(1));
+    EXPECT_EQ(6, st.GetCount(0));
+    EXPECT_EQ(8, st.Pop(1));
+    EXPECT_EQ(5, st.Pop(0));
+}
+
+TEST(TShardedStack, throws_when_all_shards_are_empty)
+{
+    TShardedStack<int> st(3, 6);
+    ASSERT_ANY_THROW(st.Pop(2));
+    EXPECT_TRUE(st.IsEmpty());
+}
+
+TEST(TShardedStack, grows_when_shared_buffer_is_full)
+{
+    TShardedStack<int> st(2, 4);
+    for (int i = 0; i < 100; i++) st.Push(i % 2, i);
+    EXPECT_EQ(100, st.GetCount());
+    EXPECT_EQ(98, st.Pop(0));
+}
+
+TEST(TShardedStack, concurrent_workers_lose_nothing)
+{
+    const int threads = 4, n = 20000;
+    TShardedStack<int> st(threads, 64, 8);
+    std::vector<long long> sums(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            int v;
+            for (int i = 0; i < n; i++) {
+                if (t % 2 == 0) st.Push(t, t * n + i);
+                else if (st.TryPop(t, v)) sums[t] += v;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    long long total = 0;
+    int v;
+    while (st.TryPop(0, v)) total += v;
+    for (long long s : sums) total += s;
+    long long expected = 0;
+    for (int t = 0; t < threads; t += 2)
+        for (int i = 0; i < n; i++) expected += t * n + i;
+    EXPECT_EQ(expected, total);
+}
@@ -0,0 +1,81 @@
+#include "TSimdMin.h"
+#include "TMultiStack.h"
+#include "TChunkedStack.h"
+#include <gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+template <class T>
+static T ScalarMin(const std::vector<T>& v) {
+    T m = v[0];
+    for (size_t i = 1; i < v.size(); i++)
+        if (v[i] < m) m = v[i];
+    return m;
+}
+
+template <class T>
+static void CheckAllSizes() {
+    unsigned seed = 7;
+    for (int n = 1; n <= 130; n++) {
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            seed = seed * 1664525 + 1013904223;
+            x = (T)((long long)(seed >> 1) - (1LL << 30));
+        }
+        EXPECT_EQ(ScalarMin(v), SimdMin(v.data(), n)) << "n = " << n;
+    }
+}
+
+TEST(TSimdMin, reports_isa)
+{
+    EXPECT_NE(nullptr, SimdMinIsa());
+}
+
+TEST(TSimdMin, matches_scalar_for_all_types_and_tails)
+{
+    CheckAllSizes<std::int32_t>();
+    CheckAllSizes<std::int64_t>();
+    CheckAllSizes<float>();
+    CheckAllSizes<double>();
+}
+
+TEST(TSimdMin, finds_extreme_int64_values)
+{
+    std::vector<std::int64_t> v(37, 1);
+    v[29] = std::numeric_limits<std::int64_t>::min();
+    EXPECT_EQ(std::numeric_limits<std::int64_t>::min(), SimdMin(v.data(), 37));
+}
+
+TEST(TSimdMin, skips_nan_like_scalar_loop)
+{
+    std::vector<double> v(50, 2.0);
+    v[10] = NAN;
+    v[40] = -1.0;
+    EXPECT_EQ(-1.0, SimdMin(v.data(), 50));
+    v[0] = NAN;
+    EXPECT_TRUE(std::isnan(SimdMin(v.data(), 50)));
+}
+
+TEST(TSimdMin, stack_and_multistack_find_min_use_simd_path)
+{
+    TStack<float> st(100);
+    TMultiStack<int> ms(3, 90);
+    std::vector<int> expected(3, 1000);
+    for (int i = 0; i < 70; i++) {
+        int v = (i * 53) % 97 - 40;
+        st.Push((float)((i * 37) % 71) - 10.5f);
+        ms.Push(i % 3, v);
+        if (v < expected[i % 3]) expected[i % 3] = v;
+    }
+    EXPECT_EQ(-10.5f, st.FindMin());
+    for (int i = 0; i < 3; i++) EXPECT_EQ(expected[i], ms.FindMin(i));
+}
+
+TEST(TSimdMin, chunked_find_min_ignores_nan_at_chunk_start)
+{
+    TChunkedStack<double> st(8);
+    for (int i = 0; i < 20; i++) st.Push(i == 8 ? NAN : 100.0 - i);
+    EXPECT_EQ(81.0, st.FindMin());
+}
@@ -0,0 +1,343 @@
+#include "TMultiStack.h"
+#include <gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+TEST(TSnapshot, checksum_depends_on_every_byte)
+{
+    unsigned char buf[21] = {};
+    std::uint64_t h = SnapshotChecksum(buf, sizeof(buf));
+    for (int i = 0; i < 21; i++) {
+        buf[i] = 1;
+        EXPECT_NE(h, SnapshotChecksum(buf, sizeof(buf)));
+        buf[i] = 0;
+    }
+}
+
+TEST(TSnapshot, binary_round_trip_keeps_values_and_capacity)
+{
+    const char* name = "snapshot_round_trip.bin";
+    TStack<double> st(100);
+    for (int i = 0; i < 77; i++) st.Push(i * 0.5);
+    st.SaveToFile(name);
+
+    TStack<double> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(100, loaded.GetLen());
+    EXPECT_EQ(77, loaded.GetCount());
+    EXPECT_TRUE(st == loaded);
+    std::remove(name);
+}
+
+struct TPoint
+{
+    int a;
+    double b;
+};
+
+TEST(TSnapshot, binary_round_trip_of_plain_struct)
+{
+    const char* name = "snapshot_pod.bin";
+    TStack<TPoint> st(10);
+    for (int i = 0; i < 7; i++) st.Push(TPoint{ i, i * 0.25 });
+    st.SaveToFile(name);
+    EXPECT_THROW(st.SaveToFile(name, TFileFormat::Text), std::invalid_argument);
+    st.SaveToFile(name);
+
+    TStack<TPoint> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(10, loaded.GetLen());
+    ASSERT_EQ(7, loaded.GetCount());
+    for (int i = 6; i >= 0; i--) {
+        TPoint p = loaded.Pop();
+        EXPECT_EQ(i, p.a);
+        EXPECT_EQ(i * 0.25, p.b);
+    }
+    std::remove(name);
+}
+
+TEST(TSnapshot, header_count_is_checked_against_file_size)
+{
+    const char* name = "snapshot_bogus_count.bin";
+    TSnapshotHeader header = MakeSnapshotHeader(sizeof(std::int64_t), 0, 0, nullptr);
+    header.count = 1;
+    header.capacity = INT_MAX;
+    {
+        std::ofstream f(name, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    TStack<std::int64_t> loaded;
+    EXPECT_THROW(loaded.LoadFromFile(name), std::runtime_error);
+    header.count = 3000000;
+    header.version = 2;
+    header.flags = (std::uint32_t)TBlockCodec::DeltaVarint;
+    {
+        std::ofstream f(name, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::uint64_t zero = 0;
+        f.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+    }
+    EXPECT_THROW(loaded.LoadFromFile(name), std::runtime_error);
+    std::remove(name);
+}
+
+TEST(TSnapshot, load_detects_text_format)
+{
+    const char* name = "snapshot_text.txt";
+    TStack<int> st(5);
+    for (int i = 0; i < 5; i++) st.Push(i * 10);
+    st.SaveToFile(name, TFileFormat::Text);
+
+    TStack<int> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_TRUE(st == loaded);
+    std::remove(name);
+}
+
+TEST(TSnapshot, load_rejects_corrupted_data)
+{
+    const char* name = "snapshot_corrupted.bin";
+    TStack<int> st(10);
+    for (int i = 0; i < 10; i++) st.Push(i);
+    st.SaveToFile(name);
+    {
+        std::fstream f(name, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(TSnapshotHeader) + 5);
+        f.put('\x7f');
+    }
+    TStack<int> loaded;
+    ASSERT_ANY_THROW(loaded.LoadFromFile(name));
+    std::remove(name);
+}
+
+TEST(TSnapshot, load_rejects_other_element_size)
+{
+    const char* name = "snapshot_elem_size.bin";
+    TStack<int> st(4);
+    st.Push(1);
+    st.SaveToFile(name);
+    TStack<long long> loaded;
+    ASSERT_ANY_THROW(loaded.LoadFromFile(name));
+    std::remove(name);
+}
+
+TEST(TSnapshot, non_trivial_types_use_text_format)
+{
+    const char* name = "snapshot_strings.txt";
+    TStack<std::string> st(3);
+    st.Push("a");
+    st.Push("b");
+    ASSERT_ANY_THROW(st.SaveToFile(name, TFileFormat::Binary));
+    st.SaveToFile(name);
+    TStack<std::string> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_TRUE(st == loaded);
+    std::remove(name);
+}
+
+TEST(TSnapshot, mapped_stack_reads_file_without_copy)
+{
+    const char* name = "snapshot_mapped.bin";
+    TStack<int> st(50);
+    for (int i = 0; i < 40; i++) st.Push(i * 3);
+    st.SaveToFile(name);
+
+    TStack<int> mapped;
+    mapped.MapFile(name, TMapMode::ReadOnly, true);
+    EXPECT_TRUE(mapped.IsMapped());
+    EXPECT_EQ(40, mapped.GetLen());
+    EXPECT_TRUE(st == mapped);
+    EXPECT_EQ(0, mapped.FindMin());
+    EXPECT_EQ(117, mapped.Pop());
+
+
+    // Push в режиме ReadOnly переносит стек в собственный буфер
+    mapped.Push(-1);
+    EXPECT_FALSE(mapped.IsMapped());
+    EXPECT_EQ(-1, mapped.Pop());
+    EXPECT_EQ(114, mapped.Top());
+    std::remove(name);
+}
+
+TEST(TSnapshot, read_only_mapping_detaches_on_top_write)
+{
+    const char* name = "snapshot_mapped_top.bin";
+    TStack<int> st(8);
+    for (int i = 0; i < 8; i++) st.Push(i);
+    st.SaveToFile(name);
+
+    TStack<int> mapped;
+    mapped.MapFile(name, TMapMode::ReadOnly);
+    // Чтение через константный Top() не копирует, запись через Top() переносит стек
+    const TStack<int>& view = mapped;
+    EXPECT_EQ(7, view.Top());
+    EXPECT_TRUE(mapped.IsMapped());
+    mapped.Top() = 5;
+    EXPECT_FALSE(mapped.IsMapped());
+    EXPECT_EQ(5, mapped.Pop());
+
+    TStack<int> again;
+    again.LoadFromFile(name);
+    EXPECT_EQ(7, again.Top());
+    std::remove(name);
+}
+
+TEST(TSnapshot, copy_on_write_mapping_does_not_change_file)
+{
+    const char* name = "snapshot_cow.bin";
+    TStack<long long> st(8);
+    for (int i = 0; i < 8; i++) st.Push(i);
+    st.SaveToFile(name);
+
+    TStack<long long> mapped;
+    mapped.SetGrowthPolicy(TGrowthPolicy::Geometric());
+    mapped.MapFile(name);
+    mapped.Top() = 100;
+    mapped.Pop();
+    mapped.Push(200);
+    EXPECT_TRUE(mapped.IsMapped());
+    mapped.Push(300);
+    EXPECT_FALSE(mapped.IsMapped());
+    EXPECT_EQ(16, mapped.GetLen());
+
+    TStack<long long> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_TRUE(st == loaded);
+    std::remove(name);
+}
+
+TEST(TSnapshot, map_rejects_text_file)
+{
+    const char* name = "snapshot_map_text.txt";
+    TStack<int> st(2);
+    st.Push(1);
+    st.SaveToFile(name, TFileFormat::Text);
+    TStack<int> mapped;
+    ASSERT_ANY_THROW(mapped.MapFile(name));
+    std::remove(name);
+}
+
+TEST(TSnapshot, text_header_gives_capacity_hint)
+{
+    const char* name = "snapshot_text_header.txt";
+    TStack<double> st(64);
+    for (int i = 0; i < 10; i++) st.Push(i / 4.0);
+    st.SaveToFile(name, TFileFormat::Text);
+
+    TStack<double> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(64, loaded.GetLen());
+    EXPECT_TRUE(st == loaded);
+    std::remove(name);
+}
+
+TEST(TSnapshot, text_header_does_not_force_huge_allocation)
+{
+    const char* name = "snapshot_text_bogus.txt";
+    {
+        std::ofstream f(name);
+        f << "#TStack count=2000000000 capacity=2000000000\n1\n2\n3\n";
+    }
+    TStack<int> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(3, loaded.GetCount());
+    EXPECT_GE(8, loaded.GetLen());
+    EXPECT_EQ(3, loaded.Pop());
+    std::remove(name);
+}
+
+TEST(TSnapshot, loads_text_without_header)
+{
+    const char* name = "snapshot_no_header.txt";
+    {
+        std::ofstream f(name);
+        for (int i = 0; i < 1000; i++) f << i << '\n';
+    }
+    TStack<int> loaded;
+    loaded.LoadFromFile(name);
+    ASSERT_EQ(1000, loaded.GetCount());
+    for (int i = 999; i >= 0; i--) EXPECT_EQ(i, loaded.Pop());
+    std::remove(name);
+}
+
+static void RemoveShards(const std::string& name, int shards)
+{
+    std::remove(name.c_str());
+    for (int k = 0; k < shards; k++) std::remove((name + "." + std::to_string(k)).c_str());
+}
+
+TEST(TSnapshot, multistack_round_trips_through_shards)
+{
+    std::string name = "snapshot_multi.manifest";
+    TMultiStack<int> ms(10, 1000);
+    for (int k = 0; k < 700; k++) ms.Push((k * 7) % 10 < 3 ? 0 : (k * 7) % 10, k);
+    ms.SaveToFile(name, 4);
+
+    TMultiStack<int> loaded;
+    loaded.LoadFromFile(name);
+    EXPECT_EQ(1000, loaded.GetLen());
+    EXPECT_EQ(10, loaded.GetStackCount());
+    EXPECT_TRUE(ms == loaded);
+    for (int i = 0; i < 10; i++) EXPECT_EQ(ms.GetCount(i), loaded.GetCount(i));
+    loaded.Push(5, -1);
+    EXPECT_EQ(-1, loaded.Pop(5));
+    RemoveShards(name, 4);
+}
+
+TEST(TSnapshot, multistack_load_detects_damaged_shard)
+{
+    std::string name = "snapshot_multi_damaged.manifest";
+    TMultiStack<long long> ms(4, 100);
+    for (int k = 0; k < 80; k++) ms.Push(k % 4, k);
+    ms.SaveToFile(name, 2);
+    {
+        std::fstream f(name + ".1", std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(TSnapshotHeader) + 3);
+        f.put('\x55');
+    }
+    TMultiStack<long long> loaded;
+    ASSERT_ANY_THROW(loaded.LoadFromFile(name));
+    RemoveShards(name, 2);
+}
+
+TEST(TSnapshot, multistack_manifest_is_validated)
+{
+    std::string name = "snapshot_multi_bad.manifest";
+    {
+        std::ofstream f(name);
+        f << "#TMultiStack version=1 elemSize=4 len=10 stacks=2 shards=1\n"
+          << "stack 0 begin=0 top=6\nstack 1 begin=5 top=7\nshard 0 first=0 file=x.0\n";
+    }
+    TMultiStack<int> loaded;
+    ASSERT_ANY_THROW(loaded.LoadFromFile(name));
+    std::remove(name.c_str());
+}
+
+TEST(TSnapshot, multistack_manifest_first_stack_starts_at_zero)
+{
+    std::string name = "snapshot_multi_offset.manifest";
+    TMultiStack<int> ms(2, 10);
+    for (int k = 0; k < 2; k++) ms.Push(0, k);
+    for (int k = 0; k < 3; k++) ms.Push(1, k);
+    ms.SaveToFile(name, 1);
+    std::string text;
+    {
+        std::ifstream f(name);
+        text.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    // Те же данные шарда, но первый подстек сдвинут от начала буфера
+    std::string::size_type p0 = text.find("stack 0 begin=0 top=2"), p1 = text.find("stack 1 begin=5 top=8");
+    ASSERT_NE(std::string::npos, p0);
+    ASSERT_NE(std::string::npos, p1);
+    text.replace(p1, 21, "stack 1 begin=7 top=10");
+    text.replace(p0, 21, "stack 0 begin=5 top=7");
+    {
+        std::ofstream f(name);
+        f << text;
+    }
+    TMultiStack<int> loaded;
+    EXPECT_THROW(loaded.LoadFromFile(name), std::runtime_error);
+    RemoveShards(name, 1);
+}
@@ -0,0 +1,94 @@
+#include "TMultiStack.h"
+#include "TSnapshotIoTesting.h"
+#include <gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static TIoOptions MakeOptions(TIoBackend backend, bool direct)
+{
+    TIoOptions io;
+    io.backend = backend;
+    io.direct = direct;
+    io.queueDepth = 4;
+    io.chunkLen = 2 * IoAlign;
+    return io;
+}
+
+// Размеры подобраны так, чтобы заголовок, хвост и граница блоков попадали в разные места
+static void CheckRoundTrip(TIoBackend backend, bool direct)
+{
+    int sizes[] = { 0, 1, 1000, 2032, 100003 };
+    for (int n : sizes) {
+        TStack<int> st(n + 5);
+        for (int i = 0; i < n; i++) st.Push(i * 7 - 3);
+        const char* name = "snapshot_io.bin";
+        TIoOptions io = MakeOptions(backend, direct);
+        st.SaveToFile(name, TFileFormat::Binary, io);
+
+        TStack<int> viaStream, viaBackend;
+        viaStream.LoadFromFile(name);
+        viaBackend.LoadFromFile(name, io);
+        EXPECT_TRUE(st == viaStream);
+        EXPECT_TRUE(st == viaBackend);
+        EXPECT_EQ(n + 5, viaBackend.GetLen());
+        std::remove(name);
+    }
+}
+
+TEST(TSnapshotIo, pwrite_round_trip)
+{
+    CheckRoundTrip(TIoBackend::Pwrite, false);
+    CheckRoundTrip(TIoBackend::Pwrite, true);
+}
+
+TEST(TSnapshotIo, io_uring_round_trip)
+{
+    CheckRoundTrip(TIoBackend::IoUring, false);
+    CheckRoundTrip(TIoBackend::IoUring, true);
+}
+
+TEST(TSnapshotIo, reports_backend_and_reads_unaligned_range)
+{
+    std::vector<char> head(100, 'h'), data(3 * IoAlign + 17);
+    for (std::size_t i = 0; i < data.size(); i++) data[i] = (char)(i * 31);
+    TIoOptions io = MakeOptions(TIoBackend::IoUring, true);
+    TIoBackend used = WriteFileRange("snapshot_io_range.bin", head.data(), head.size(), data.data(), data.size(), io);
+    EXPECT_EQ(IsIoUringAvailable() ? TIoBackend::IoUring : TIoBackend::Pwrite, used);
+
+    std::vector<char> back(data.size() - 5);
+    ReadFileRange("snapshot_io_range.bin", head.size() + 5, back.data(), back.size(), io);
+    EXPECT_TRUE(std::equal(back.begin(), back.end(), data.begin() + 5));
+    // Чтение за концом файла - ошибка
+    std::vector<char> tooLong(data.size() + 1);
+    EXPECT_THROW(ReadFileRange("snapshot_io_range.bin", head.size(), tooLong.data(), tooLong.size(), io), std::runtime_error);
+    std::remove("snapshot_io_range.bin");
+}
+
+TEST(TSnapshotIo, falls_back_to_pwrite_without_io_uring_opcodes)
+{
+    DisableIoUringOps(true);
+    EXPECT_FALSE(IsIoUringAvailable());
+    std::vector<char> data(5 * IoAlign + 3, 'x');
+    TIoOptions io = MakeOptions(TIoBackend::IoUring, false);
+    EXPECT_EQ(TIoBackend::Pwrite, WriteFileRange("snapshot_io_probe.bin", "hd", 2, data.data(), data.size(), io));
+    std::vector<char> back(data.size());
+    EXPECT_EQ(TIoBackend::Pwrite, ReadFileRange("snapshot_io_probe.bin", 2, back.data(), back.size(), io));
+    EXPECT_TRUE(back == data);
+    DisableIoUringOps(false);
+    std::remove("snapshot_io_probe.bin");
+}
+
+TEST(TSnapshotIo, rejects_bad_options)
+{
+    TStack<int> st(4);
+    st.Push(1);
+    TIoOptions io = MakeOptions(TIoBackend::Pwrite, false);
+    io.chunkLen = 1000;
+    EXPECT_THROW(st.SaveToFile("snapshot_io_bad.bin", TFileFormat::Binary, io), std::invalid_argument);
+    io.chunkLen = IoAlign;
+    io.queueDepth = 0;
+    EXPECT_THROW(st.SaveToFile("snapshot_io_bad.bin", TFileFormat::Binary, io), std::invalid_argument);
+    EXPECT_THROW(st.LoadFromFile("snapshot_io_missing.bin", io), std::runtime_error);
+}
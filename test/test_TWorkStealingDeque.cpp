@@ -0,0 +1,69 @@
+#include "TWorkStealingDeque.h"
+#include <gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(TWorkStealingDeque, throws_when_create_with_wrong_len)
+{
+    ASSERT_ANY_THROW(TWorkStealingDeque<int> dq(0));
+}
+
+TEST(TWorkStealingDeque, owner_pops_lifo_and_thief_steals_fifo)
+{
+    TWorkStealingDeque<int> dq(4);
+    for (int i = 0; i < 5; i++) dq.Push(i);
+    int v;
+    ASSERT_TRUE(dq.Steal(v));
+    EXPECT_EQ(0, v);
+    EXPECT_EQ(4, dq.Pop());
+    EXPECT_EQ(3, dq.GetCount());
+}
+
+TEST(TWorkStealingDeque, grows_buffer)
+{
+    TWorkStealingDeque<int> dq(2);
+    for (int i = 0; i < 100; i++) dq.Push(i);
+    EXPECT_EQ(128, dq.GetLen());
+    for (int i = 99; i >= 0; i--) EXPECT_EQ(i, dq.Pop());
+    EXPECT_TRUE(dq.IsEmpty());
+    ASSERT_ANY_THROW(dq.Pop());
+}
+
+TEST(TWorkStealingDeque, deques_share_arena)
+{
+    TDequeArena arena(1024);
+    TWorkStealingDeque<int> a(16, &arena), b(16, &arena);
+    EXPECT_EQ(2 * 16 * sizeof(std::atomic<int>), arena.GetUsed());
+    for (int i = 0; i < 1000; i++) a.Push(i), b.Push(-i);
+    EXPECT_EQ(999, a.Pop());
+    EXPECT_EQ(-999, b.Pop());
+}
+
+TEST(TWorkStealingDeque, every_item_is_taken_exactly_once)
+{
+    const int n = 200000, thieves = 3;
+    TWorkStealingDeque<int> dq(8);
+    std::vector<std::atomic<int>> taken(n);
+    for (auto& x : taken) x.store(0);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> pool;
+    for (int k = 0; k < thieves; k++) {
+        pool.emplace_back([&]() {
+            int v;
+            while (!done.load() || !dq.IsEmpty())
+                if (dq.Steal(v)) taken[v]++;
+        });
+    }
+    int v;
+    for (int i = 0; i < n; i++) {
+        dq.Push(i);
+        if (i % 3 == 0 && dq.TryPop(v)) taken[v]++;
+    }
+    while (dq.TryPop(v)) taken[v]++;
+    done.store(true);
+    for (auto& th : pool) th.join();
+    int bad = 0;
+    for (auto& x : taken) bad += x.load() != 1;
+    EXPECT_EQ(0, bad);
+}